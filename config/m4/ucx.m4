@@ -93,6 +93,44 @@ AS_IF([test -d "$with_ucx"],
 		],
 		[AC_MSG_NOTICE([UCX: ucp_get_nbi NOT found])
 		])
+	      AC_COMPILE_IFELSE(
+		[AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]], [ucp_put_nbx])],
+		[AC_MSG_NOTICE([UCX: ucp_put_nbx found])
+ 	         AC_DEFINE([HAVE_UCP_PUT_NBX], [1], [UCX has ucp_put_nbx])
+		],
+		[AC_MSG_NOTICE([UCX: ucp_put_nbx NOT found])
+		])
+	      AC_COMPILE_IFELSE(
+		[AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]],
+				 [[ucp_request_param_t p;
+				   p.op_attr_mask = UCP_OP_ATTR_FIELD_MEMH;
+				   p.memh = NULL;]])],
+		[AC_MSG_NOTICE([UCX: memory handles for operations found])
+ 	         AC_DEFINE([HAVE_UCP_OP_ATTR_FIELD_MEMH], [1], [UCX operations take a memory handle])
+		],
+		[AC_MSG_NOTICE([UCX: memory handles for operations NOT found])
+		])
+	      AC_COMPILE_IFELSE(
+		[AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]], [ucp_ep_flush_nbx])],
+		[AC_MSG_NOTICE([UCX: ucp_ep_flush_nbx found])
+ 	         AC_DEFINE([HAVE_UCP_EP_FLUSH_NBX], [1], [UCX has ucp_ep_flush_nbx])
+		],
+		[AC_MSG_NOTICE([UCX: ucp_ep_flush_nbx NOT found])
+		])
+	      AC_COMPILE_IFELSE(
+		[AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]], [ucp_atomic_op_nbx])],
+		[AC_MSG_NOTICE([UCX: ucp_atomic_op_nbx found])
+ 	         AC_DEFINE([HAVE_UCP_ATOMIC_OP_NBX], [1], [UCX has ucp_atomic_op_nbx])
+		],
+		[AC_MSG_NOTICE([UCX: ucp_atomic_op_nbx NOT found])
+		])
+	      AC_COMPILE_IFELSE(
+		[AC_LANG_PROGRAM([[#include <ucp/api/ucp.h>]], [ucp_am_send_nb])],
+		[AC_MSG_NOTICE([UCX: ucp_am_send_nb found])
+ 	         AC_DEFINE([HAVE_UCP_AM_SEND_NB], [1], [UCX has active messages])
+		],
+		[AC_MSG_NOTICE([UCX: ucp_am_send_nb NOT found])
+		])
 	      AC_LANG_POP([C])
 	      UCX_DIR="$with_ucx"
 	      AC_DEFINE_UNQUOTED([UCX_DIR], ["$UCX_DIR"], [UCX installation directory])
@@ -0,0 +1,95 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Time small puts to symmetric addresses in different memory
+ * regions, to show the per-operation cost of address translation.
+ *
+ * "same" puts always hit one region; "alternating" puts flip between
+ * the global variables region and the symmetric heap, so every
+ * operation has to look the region up again.  Re-run with more
+ * symmetric heaps configured to see how the cost scales with the
+ * number of regions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <shmem.h>
+#include <shmemx.h>
+
+#define DEFAULT_ITERS 1000000
+
+static long global_dest;
+
+static double
+time_puts(long *a, long *b, int pe, long iters)
+{
+    const long src = 42;
+    double t;
+    long i;
+
+    shmem_barrier_all();
+
+    t = shmemx_wtime();
+    for (i = 0; i < iters; ++i) {
+        long *dest = (i & 1) ? b : a;
+
+        shmem_putmem(dest, &src, sizeof(src), pe);
+    }
+    shmem_quiet();
+    t = shmemx_wtime() - t;
+
+    shmem_barrier_all();
+
+    return t;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int me, npes, pe;
+    long iters = DEFAULT_ITERS;
+    long *heap_dest;
+    double t_same, t_alt, t_check;
+    long i;
+    int acc = 0;
+
+    if (argc > 1) {
+        iters = atol(argv[1]);
+    }
+
+    shmem_init();
+
+    me = shmem_my_pe();
+    npes = shmem_n_pes();
+    pe = (me + 1) % npes;
+
+    heap_dest = (long *) shmem_malloc(sizeof(*heap_dest));
+
+    t_same = time_puts(heap_dest, heap_dest, pe, iters);
+    t_alt  = time_puts(&global_dest, heap_dest, pe, iters);
+
+    /* translation alone, no network traffic */
+    t_check = shmemx_wtime();
+    for (i = 0; i < iters; ++i) {
+        acc += shmem_addr_accessible((i & 1) ? heap_dest : &global_dest,
+                                     pe);
+    }
+    t_check = shmemx_wtime() - t_check;
+
+    if (me == 0) {
+        printf("# %ld iterations, %d PEs\n", iters, npes);
+        printf("%-24s %10.2f ns/op\n", "put (same region)",
+               1.0e9 * t_same / iters);
+        printf("%-24s %10.2f ns/op\n", "put (alternating)",
+               1.0e9 * t_alt / iters);
+        printf("%-24s %10.2f ns/op (%d)\n", "addr_accessible",
+               1.0e9 * t_check / iters, acc > 0);
+    }
+
+    shmem_free(heap_dest);
+
+    shmem_finalize();
+
+    return 0;
+}
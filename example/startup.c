@@ -0,0 +1,93 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Time shmem_init() and shmem_finalize() over a number of rounds, to
+ * track how start-up scales as the number of PEs grows.
+ *
+ * init times are the maximum across PEs, i.e. how long the slowest PE
+ * took to get going.  finalize times are for PE 0 (nothing to reduce
+ * with once the library's gone).
+ *
+ * N.B. running more than 1 round re-initializes the library after
+ * finalizing it, which this implementation allows but the
+ * specification doesn't require.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <shmem.h>
+
+static double
+now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return (double) t.tv_sec + (t.tv_nsec / 1.0e9);
+}
+
+static long sync[SHMEM_REDUCE_SYNC_SIZE];
+static double wrk[SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+
+static double t_local;
+static double t_slowest;
+
+int
+main(int argc, char *argv[])
+{
+    int rounds = 1;
+    double t_fin = 0.0;
+    int r;
+
+    if (argc > 1) {
+        rounds = atoi(argv[1]);
+    }
+
+    for (r = 0; r < rounds; ++r) {
+        double t;
+        int me, npes;
+        int i;
+
+        t = now();
+        shmem_init();
+        t_local = now() - t;
+
+        me = shmem_my_pe();
+        npes = shmem_n_pes();
+
+        for (i = 0; i < SHMEM_REDUCE_SYNC_SIZE; ++i) {
+            sync[i] = SHMEM_SYNC_VALUE;
+        }
+        shmem_barrier_all();
+
+        shmem_double_max_to_all(&t_slowest, &t_local, 1,
+                                0, 0, npes, wrk, sync);
+
+        if (me == 0) {
+            if (r == 0) {
+                printf("# %d PEs\n", npes);
+                printf("# %-6s %14s %14s\n",
+                       "round", "init (s)", "finalize (s)");
+            }
+            else {
+                /* finalize from the round before */
+                printf("%14.6f\n", t_fin);
+            }
+            printf("  %-6d %14.6f ", r, t_slowest);
+            fflush(stdout);
+        }
+
+        t = now();
+        shmem_finalize();
+        t_fin = now() - t;
+
+        if ((me == 0) && (r == rounds - 1)) {
+            printf("%14.6f\n", t_fin);
+        }
+    }
+
+    return 0;
+}
@@ -2126,6 +2126,150 @@ extern "C"
     /* see \ref shmem_ulong_atomic_fetch_xor() */
     SHMEM_DECL_AMO2(fetch_xor, uint64, uint64_t)
 
+    /**
+     * @brief non-blocking atomic fetching operations
+     * @page shmem_long_atomic_fetch_add_nbi
+     * @section Synopsis
+     *
+     * @subsection c C/C++
+     @code
+     void shmem_ctx_long_atomic_fetch_add_nbi(shmem_ctx_t ctx,
+                                              long *fetch, long *target,
+                                              long value, int pe);
+     void shmem_long_atomic_fetch_add_nbi(long *fetch, long *target,
+                                          long value, int pe);
+     @endcode
+     *
+     * and similarly for fetch_inc, swap, compare_swap, fetch_and,
+     * fetch_or, fetch_xor.
+     *
+     * @section Effect
+     *
+     * Start the atomic operation on another PE and return
+     * immediately.  The old value is only guaranteed to be in @a
+     * fetch after a subsequent quiet on the context.
+     *
+     * @section Return
+     * None.
+     *
+     */
+#define API_DECL_AMO1_NBI(_op, _name, _type)                            \
+    /* see \ref shmem_long_atomic_fetch_add_nbi() */                    \
+    void shmem_ctx_##_name##_atomic_##_op##_nbi(shmem_ctx_t ctx,        \
+                                                _type *fetch,           \
+                                                _type *target,          \
+                                                int pe);                \
+    /* see \ref shmem_long_atomic_fetch_add_nbi() */                    \
+    void shmem_##_name##_atomic_##_op##_nbi(_type *fetch,               \
+                                            _type *target,              \
+                                            int pe);
+
+#define API_DECL_AMO2_NBI(_op, _name, _type)                            \
+    /* see \ref shmem_long_atomic_fetch_add_nbi() */                    \
+    void shmem_ctx_##_name##_atomic_##_op##_nbi(shmem_ctx_t ctx,        \
+                                                _type *fetch,           \
+                                                _type *target,          \
+                                                _type value, int pe);   \
+    /* see \ref shmem_long_atomic_fetch_add_nbi() */                    \
+    void shmem_##_name##_atomic_##_op##_nbi(_type *fetch,               \
+                                            _type *target,              \
+                                            _type value, int pe);
+
+#define API_DECL_AMO3_NBI(_op, _name, _type)                            \
+    /* see \ref shmem_long_atomic_fetch_add_nbi() */                    \
+    void shmem_ctx_##_name##_atomic_##_op##_nbi(shmem_ctx_t ctx,        \
+                                                _type *fetch,           \
+                                                _type *target,          \
+                                                _type cond,             \
+                                                _type value, int pe);   \
+    /* see \ref shmem_long_atomic_fetch_add_nbi() */                    \
+    void shmem_##_name##_atomic_##_op##_nbi(_type *fetch,               \
+                                            _type *target,              \
+                                            _type cond, _type value,    \
+                                            int pe);
+
+    API_DECL_AMO2_NBI(fetch_add, int, int)
+    API_DECL_AMO2_NBI(fetch_add, long, long)
+    API_DECL_AMO2_NBI(fetch_add, longlong, long long)
+    API_DECL_AMO2_NBI(fetch_add, uint, unsigned int)
+    API_DECL_AMO2_NBI(fetch_add, ulong, unsigned long)
+    API_DECL_AMO2_NBI(fetch_add, ulonglong, unsigned long long)
+    API_DECL_AMO2_NBI(fetch_add, int32, int32_t)
+    API_DECL_AMO2_NBI(fetch_add, int64, int64_t)
+    API_DECL_AMO2_NBI(fetch_add, uint32, uint32_t)
+    API_DECL_AMO2_NBI(fetch_add, uint64, uint64_t)
+    API_DECL_AMO2_NBI(fetch_add, size, size_t)
+    API_DECL_AMO2_NBI(fetch_add, ptrdiff, ptrdiff_t)
+
+    API_DECL_AMO1_NBI(fetch_inc, int, int)
+    API_DECL_AMO1_NBI(fetch_inc, long, long)
+    API_DECL_AMO1_NBI(fetch_inc, longlong, long long)
+    API_DECL_AMO1_NBI(fetch_inc, uint, unsigned int)
+    API_DECL_AMO1_NBI(fetch_inc, ulong, unsigned long)
+    API_DECL_AMO1_NBI(fetch_inc, ulonglong, unsigned long long)
+    API_DECL_AMO1_NBI(fetch_inc, int32, int32_t)
+    API_DECL_AMO1_NBI(fetch_inc, int64, int64_t)
+    API_DECL_AMO1_NBI(fetch_inc, uint32, uint32_t)
+    API_DECL_AMO1_NBI(fetch_inc, uint64, uint64_t)
+    API_DECL_AMO1_NBI(fetch_inc, size, size_t)
+    API_DECL_AMO1_NBI(fetch_inc, ptrdiff, ptrdiff_t)
+
+    API_DECL_AMO2_NBI(swap, float, float)
+    API_DECL_AMO2_NBI(swap, double, double)
+    API_DECL_AMO2_NBI(swap, int, int)
+    API_DECL_AMO2_NBI(swap, long, long)
+    API_DECL_AMO2_NBI(swap, longlong, long long)
+    API_DECL_AMO2_NBI(swap, uint, unsigned int)
+    API_DECL_AMO2_NBI(swap, ulong, unsigned long)
+    API_DECL_AMO2_NBI(swap, ulonglong, unsigned long long)
+    API_DECL_AMO2_NBI(swap, int32, int32_t)
+    API_DECL_AMO2_NBI(swap, int64, int64_t)
+    API_DECL_AMO2_NBI(swap, uint32, uint32_t)
+    API_DECL_AMO2_NBI(swap, uint64, uint64_t)
+    API_DECL_AMO2_NBI(swap, size, size_t)
+    API_DECL_AMO2_NBI(swap, ptrdiff, ptrdiff_t)
+
+    API_DECL_AMO3_NBI(compare_swap, int, int)
+    API_DECL_AMO3_NBI(compare_swap, long, long)
+    API_DECL_AMO3_NBI(compare_swap, longlong, long long)
+    API_DECL_AMO3_NBI(compare_swap, uint, unsigned int)
+    API_DECL_AMO3_NBI(compare_swap, ulong, unsigned long)
+    API_DECL_AMO3_NBI(compare_swap, ulonglong, unsigned long long)
+    API_DECL_AMO3_NBI(compare_swap, int32, int32_t)
+    API_DECL_AMO3_NBI(compare_swap, int64, int64_t)
+    API_DECL_AMO3_NBI(compare_swap, uint32, uint32_t)
+    API_DECL_AMO3_NBI(compare_swap, uint64, uint64_t)
+    API_DECL_AMO3_NBI(compare_swap, size, size_t)
+    API_DECL_AMO3_NBI(compare_swap, ptrdiff, ptrdiff_t)
+
+    API_DECL_AMO2_NBI(fetch_and, uint, unsigned int)
+    API_DECL_AMO2_NBI(fetch_and, ulong, unsigned long)
+    API_DECL_AMO2_NBI(fetch_and, ulonglong, unsigned long long)
+    API_DECL_AMO2_NBI(fetch_and, int32, int32_t)
+    API_DECL_AMO2_NBI(fetch_and, int64, int64_t)
+    API_DECL_AMO2_NBI(fetch_and, uint32, uint32_t)
+    API_DECL_AMO2_NBI(fetch_and, uint64, uint64_t)
+
+    API_DECL_AMO2_NBI(fetch_or, uint, unsigned int)
+    API_DECL_AMO2_NBI(fetch_or, ulong, unsigned long)
+    API_DECL_AMO2_NBI(fetch_or, ulonglong, unsigned long long)
+    API_DECL_AMO2_NBI(fetch_or, int32, int32_t)
+    API_DECL_AMO2_NBI(fetch_or, int64, int64_t)
+    API_DECL_AMO2_NBI(fetch_or, uint32, uint32_t)
+    API_DECL_AMO2_NBI(fetch_or, uint64, uint64_t)
+
+    API_DECL_AMO2_NBI(fetch_xor, uint, unsigned int)
+    API_DECL_AMO2_NBI(fetch_xor, ulong, unsigned long)
+    API_DECL_AMO2_NBI(fetch_xor, ulonglong, unsigned long long)
+    API_DECL_AMO2_NBI(fetch_xor, int32, int32_t)
+    API_DECL_AMO2_NBI(fetch_xor, int64, int64_t)
+    API_DECL_AMO2_NBI(fetch_xor, uint32, uint32_t)
+    API_DECL_AMO2_NBI(fetch_xor, uint64, uint64_t)
+
+#undef API_DECL_AMO1_NBI
+#undef API_DECL_AMO2_NBI
+#undef API_DECL_AMO3_NBI
+
     /**
      * @brief increment symmetric variable
      * @page shmem_long_atomic_inc
@@ -48,6 +48,21 @@
 # define _WUR
 #endif
 
+/*
+ * Mark global/static variables that are accessed remotely, e.g.
+ *
+ *     static long counter SHMEM_SYMMETRIC;
+ *
+ * so that with SHMEM_GLOBALS_SECTION set, only those get registered
+ * for remote access, not the whole of the program's data and BSS.
+ */
+#if defined(__GNUC__)
+# define SHMEM_SYMMETRIC                                        \
+    __attribute__((__section__("shmem_symmetric"), __used__))
+#else
+# define SHMEM_SYMMETRIC
+#endif
+
 enum shmem_cmp_constants {
     SHMEM_CMP_EQ = 0,
     SHMEM_CMP_NE,
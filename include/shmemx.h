@@ -146,6 +146,69 @@ extern "C"
     void shmemx_ctx_start_session(shmem_ctx_t ctx);
     void shmemx_ctx_end_session(shmem_ctx_t ctx);
 
+    /*
+     * extra context options, can be or'ed with SHMEM_CTX_*
+     *
+     * SHMEMX_CTX_COALESCE: small puts to the same PE that extend a
+     * contiguous run are buffered and sent together at the next
+     * fence, quiet or session end, or when the buffer fills up.
+     * Only honoured on private or serialized contexts.
+     */
+    enum shmemx_ctx_attrs {
+        SHMEMX_CTX_COALESCE = SHMEM_BIT_SET(16)
+    };
+
+    /*
+     * atomics outside the 1.x API
+     *
+     * Floating-point add, and min/max.  These are applied by the
+     * target PE, so they are not atomic with respect to the standard
+     * atomic operations on the same variable.
+     */
+
+#define SHMEMX_DECL_FETCH_OP(_op, _name, _type)                         \
+    _type shmemx_ctx_##_name##_atomic_fetch_##_op(shmem_ctx_t ctx,      \
+                                                  _type *target,        \
+                                                  _type value, int pe); \
+    void shmemx_ctx_##_name##_atomic_##_op(shmem_ctx_t ctx,             \
+                                           _type *target,               \
+                                           _type value, int pe);        \
+    _type shmemx_##_name##_atomic_fetch_##_op(_type *target,            \
+                                              _type value, int pe);     \
+    void shmemx_##_name##_atomic_##_op(_type *target,                   \
+                                       _type value, int pe);
+
+    SHMEMX_DECL_FETCH_OP(add, float, float)
+    SHMEMX_DECL_FETCH_OP(add, double, double)
+
+    SHMEMX_DECL_FETCH_OP(min, int, int)
+    SHMEMX_DECL_FETCH_OP(min, long, long)
+    SHMEMX_DECL_FETCH_OP(min, longlong, long long)
+    SHMEMX_DECL_FETCH_OP(min, uint, unsigned int)
+    SHMEMX_DECL_FETCH_OP(min, ulong, unsigned long)
+    SHMEMX_DECL_FETCH_OP(min, ulonglong, unsigned long long)
+    SHMEMX_DECL_FETCH_OP(min, int32, int32_t)
+    SHMEMX_DECL_FETCH_OP(min, int64, int64_t)
+    SHMEMX_DECL_FETCH_OP(min, uint32, uint32_t)
+    SHMEMX_DECL_FETCH_OP(min, uint64, uint64_t)
+    SHMEMX_DECL_FETCH_OP(min, float, float)
+    SHMEMX_DECL_FETCH_OP(min, double, double)
+
+    SHMEMX_DECL_FETCH_OP(max, int, int)
+    SHMEMX_DECL_FETCH_OP(max, long, long)
+    SHMEMX_DECL_FETCH_OP(max, longlong, long long)
+    SHMEMX_DECL_FETCH_OP(max, uint, unsigned int)
+    SHMEMX_DECL_FETCH_OP(max, ulong, unsigned long)
+    SHMEMX_DECL_FETCH_OP(max, ulonglong, unsigned long long)
+    SHMEMX_DECL_FETCH_OP(max, int32, int32_t)
+    SHMEMX_DECL_FETCH_OP(max, int64, int64_t)
+    SHMEMX_DECL_FETCH_OP(max, uint32, uint32_t)
+    SHMEMX_DECL_FETCH_OP(max, uint64, uint64_t)
+    SHMEMX_DECL_FETCH_OP(max, float, float)
+    SHMEMX_DECL_FETCH_OP(max, double, double)
+
+#undef SHMEMX_DECL_FETCH_OP
+
     /*
      * multiple symmetric heap support
      */
@@ -175,6 +238,25 @@ extern "C"
     void *shmemx_align_by_name(const char *name,
                                size_t a, size_t s);
 
+    /*
+     * what's in a heap on this PE.  used/free include allocator
+     * overhead; fragmentation is the share of free space not in
+     * the largest free block (0 = none).
+     */
+    typedef struct shmemx_heap_stats {
+        size_t capacity;        /* bytes in heap */
+        size_t used;            /* bytes in use */
+        size_t free;            /* bytes free */
+        size_t largest_free;    /* largest free block */
+        size_t blocks;          /* blocks allocated now */
+        size_t allocs;          /* allocations so far */
+        size_t peak;            /* most bytes allocated at once */
+        double fragmentation;
+    } shmemx_heap_stats_t;
+
+    int shmemx_heap_stats(shmemx_heap_index_t index,
+                          shmemx_heap_stats_t *stats);
+
 #if SHMEM_HAS_C11
 
 #define shmemx_malloc(_arg1, _s)                            \
@@ -209,6 +291,33 @@ extern "C"
 
 #endif /* SHMEM_HAS_C11 */
 
+    /*
+     * shmem_malloc_with_hints: data mostly read, in bulk (goes in
+     * a huge-page heap if there is one)
+     */
+#define SHMEMX_MALLOC_BULK_READ_MOSTLY (1L << 16)
+
+    /*
+     * allocate/free many symmetric blocks from the default heap with
+     * one synchronization.  malloc returns 0 on success, otherwise
+     * nothing was allocated and all of ptrs[] is NULL.
+     */
+    int shmemx_malloc_batch(size_t n, const size_t sizes[], void *ptrs[]);
+    void shmemx_free_batch(size_t n, void *ptrs[]);
+
+    /*
+     * collective: hand memory freed in deferred mode back to the heap
+     */
+    void shmemx_heap_reclaim(void);
+
+    /*
+     * local (not symmetric) memory already registered with the
+     * network, for put sources.  Not collective.  alloc returns
+     * NULL if the pool is off or full.
+     */
+    void *shmemx_alloc_local_registered(size_t size);
+    void shmemx_free_local_registered(void *ptr);
+
     enum interoperability {
         UPC_THREADS_ARE_PES = 0,
         MPI_PROCESSES_ARE_PES,
@@ -1197,6 +1197,14 @@ size_t mspace_max_footprint(mspace msp);
 struct mallinfo mspace_mallinfo(mspace msp);
 #endif /* NO_MALLINFO */
 
+/*
+  mspace_usage reports bytes in use and free, like mallinfo, plus
+  what mallinfo doesn't: the largest free chunk (counting top), to
+  gauge fragmentation.  Sizes include chunk overhead.
+*/
+void mspace_usage(mspace msp, size_t *inuse_p, size_t *free_p,
+                  size_t *largest_p);
+
 /*
   mspace_malloc_stats behaves as malloc_stats, but reports
   properties of the given space.
@@ -5220,6 +5228,45 @@ struct mallinfo mspace_mallinfo(mspace msp) {
 }
 #endif /* NO_MALLINFO */
 
+void mspace_usage(mspace msp, size_t *inuse_p, size_t *free_p,
+                  size_t *largest_p) {
+  mstate m = (mstate)msp;
+  size_t inuse = 0;
+  size_t mfree = 0;
+  size_t largest = 0;
+  if (!ok_magic(m)) {
+    USAGE_ERROR_ACTION(m,m);
+  }
+  else if (!PREACTION(m)) {
+    check_malloc_state(m);
+    if (is_initialized(m)) {
+      msegmentptr s = &m->seg;
+      mfree = largest = m->topsize;
+      while (s != 0) {
+        mchunkptr q = align_as_chunk(s->base);
+        while (segment_holds(s, q) &&
+               q != m->top && q->head != FENCEPOST_HEAD) {
+          size_t sz = chunksize(q);
+          if (cinuse(q)) {
+            inuse += sz;
+          }
+          else {
+            mfree += sz;
+            if (sz > largest)
+              largest = sz;
+          }
+          q = next_chunk(q);
+        }
+        s = s->next;
+      }
+    }
+    POSTACTION(m);
+  }
+  *inuse_p = inuse;
+  *free_p = mfree;
+  *largest_p = largest;
+}
+
 size_t mspace_usable_size(void* mem) {
   if (mem != 0) {
     mchunkptr p = mem2chunk(mem);
@@ -24,5 +24,8 @@ extern void   *mspace_realloc(mspace msp, void *mem, size_t newsize);
 extern void   *mspace_memalign(mspace msp, size_t alignment, size_t bytes);
 extern void    mspace_free(mspace msp, void *mem);
 extern size_t  mspace_footprint(mspace msp);
+extern size_t  mspace_usable_size(void *mem);
+extern void    mspace_usage(mspace msp, size_t *inuse_p, size_t *free_p,
+                            size_t *largest_p);
 
 #endif /* ! _DLMALLOC_H */
@@ -4,12 +4,95 @@
 
 #include "memalloc.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 /**
  * the memory area we manage in this unit.
  *
  * Not visible to anyone else
  */
 static mspace myspace;
+static size_t mycapacity;
+
+/**
+ * areas added when the heap grows.  All PEs try them in the same
+ * order, so allocations stay symmetric.
+ */
+#define MAX_EXTENSIONS 64
+
+typedef struct extension {
+    mspace space;
+    char *base;
+    char *end;
+} extension_t;
+
+static extension_t extensions[MAX_EXTENSIONS];
+static int nextensions = 0;
+
+/**
+ * running counts, for usage reports
+ */
+static size_t nblocks = 0;
+static size_t nallocs = 0;
+static size_t live = 0;
+static size_t peak = 0;
+
+inline static void
+count_resize(size_t old_size, size_t new_size)
+{
+    live = live - old_size + new_size;
+    if (live > peak) {
+        peak = live;
+    }
+}
+
+inline static void *
+count_alloc(void *addr)
+{
+    if (addr != NULL) {
+        ++nblocks;
+        ++nallocs;
+        count_resize(0, mspace_usable_size(addr));
+    }
+
+    return addr;
+}
+
+inline static void
+count_free(void *addr)
+{
+    if (addr != NULL) {
+        --nblocks;
+        live -= mspace_usable_size(addr);
+    }
+}
+
+/**
+ * frees waiting to be handed back to the pool (deferred mode)
+ */
+static void **deferred = NULL;
+static size_t ndeferred = 0;
+static size_t maxdeferred = 0;
+
+/**
+ * which area is ADDR in?
+ */
+inline static mspace
+owner(void *addr)
+{
+    const char *a = (const char *) addr;
+    int i;
+
+    for (i = 0; i < nextensions; ++i) {
+        if ((extensions[i].base <= a) && (a < extensions[i].end)) {
+            return extensions[i].space;
+            /* NOT REACHED */
+        }
+    }
+
+    return myspace;
+}
 
 /**
  * initialize the memory pool
@@ -18,6 +101,9 @@ void
 shmema_init(void *base, size_t capacity)
 {
     myspace = create_mspace_with_base(base, capacity, 1);
+    mycapacity = capacity;
+
+    nblocks = nallocs = live = peak = 0;
 }
 
 /**
@@ -27,6 +113,37 @@ void
 shmema_finalize(void)
 {
     destroy_mspace(myspace);
+
+    nextensions = 0;
+
+    free(deferred);
+    deferred = NULL;
+    ndeferred = maxdeferred = 0;
+}
+
+/**
+ * add CAPACITY bytes at BASE to the pool.  Returns 0 on success,
+ * non-zero if there's no room to track it.
+ */
+int
+shmema_extend(void *base, size_t capacity)
+{
+    extension_t *ep;
+
+    if (nextensions == MAX_EXTENSIONS) {
+        return -1;
+        /* NOT REACHED */
+    }
+
+    ep = & extensions[nextensions];
+
+    ep->space = create_mspace_with_base(base, capacity, 1);
+    ep->base = (char *) base;
+    ep->end = ep->base + capacity;
+
+    ++nextensions;
+
+    return 0;
 }
 
 /**
@@ -46,8 +163,13 @@ void *
 shmema_malloc(size_t size)
 {
     void *addr = mspace_malloc(myspace, size);
+    int i;
 
-    return addr;
+    for (i = 0; (addr == NULL) && (i < nextensions); ++i) {
+        addr = mspace_malloc(extensions[i].space, size);
+    }
+
+    return count_alloc(addr);
 }
 
 /**
@@ -58,8 +180,13 @@ void *
 shmema_calloc(size_t count, size_t size)
 {
     void *addr = mspace_calloc(myspace, count, size);
+    int i;
 
-    return addr;
+    for (i = 0; (addr == NULL) && (i < nextensions); ++i) {
+        addr = mspace_calloc(extensions[i].space, count, size);
+    }
+
+    return count_alloc(addr);
 }
 
 /**
@@ -68,7 +195,67 @@ shmema_calloc(size_t count, size_t size)
 void
 shmema_free(void *addr)
 {
-    mspace_free(myspace, addr);
+    count_free(addr);
+
+    mspace_free(owner(addr), addr);
+}
+
+/*
+ * how many bytes can be used at ADDR (0 if NULL)
+ */
+size_t
+shmema_usable_size(void *addr)
+{
+    return mspace_usable_size(addr);
+}
+
+/**
+ * queue ADDR to be released by shmema_reclaim().  Returns 0 on
+ * success, non-zero if it couldn't be queued.
+ */
+int
+shmema_free_deferred(void *addr)
+{
+    if (ndeferred == maxdeferred) {
+        const size_t n = (maxdeferred > 0) ? (2 * maxdeferred) : 64;
+        void **d = (void **) realloc(deferred, n * sizeof(*d));
+
+        if (d == NULL) {
+            return -1;
+            /* NOT REACHED */
+        }
+
+        deferred = d;
+        maxdeferred = n;
+    }
+
+    deferred[ndeferred++] = addr;
+
+    return 0;
+}
+
+/**
+ * how many frees are queued
+ */
+size_t
+shmema_deferred(void)
+{
+    return ndeferred;
+}
+
+/**
+ * release everything queued, in the order it was freed
+ */
+void
+shmema_reclaim(void)
+{
+    size_t i;
+
+    for (i = 0; i < ndeferred; ++i) {
+        shmema_free(deferred[i]);
+    }
+
+    ndeferred = 0;
 }
 
 /**
@@ -77,7 +264,29 @@ shmema_free(void *addr)
 void *
 shmema_realloc(void *addr, size_t new_size)
 {
-    void *new_addr = mspace_realloc(myspace, addr, new_size);
+    size_t old_size;
+    void *new_addr;
+
+    if (addr == NULL) {
+        return shmema_malloc(new_size);
+        /* NOT REACHED */
+    }
+
+    old_size = mspace_usable_size(addr);
+
+    new_addr = mspace_realloc(owner(addr), addr, new_size);
+    if (new_addr != NULL) {
+        count_resize(old_size, mspace_usable_size(new_addr));
+    }
+    /* no room where it is, so try moving it to another area */
+    else if (nextensions > 0) {
+        new_addr = shmema_malloc(new_size);
+        if (new_addr != NULL) {
+            memcpy(new_addr, addr,
+                   (old_size < new_size) ? old_size : new_size);
+            shmema_free(addr);
+        }
+    }
 
     return new_addr;
 }
@@ -89,6 +298,39 @@ void *
 shmema_align(size_t alignment, size_t size)
 {
     void *aligned_addr = mspace_memalign(myspace, alignment, size);
+    int i;
+
+    for (i = 0; (aligned_addr == NULL) && (i < nextensions); ++i) {
+        aligned_addr = mspace_memalign(extensions[i].space, alignment, size);
+    }
+
+    return count_alloc(aligned_addr);
+}
+
+/**
+ * fill in what's in the pool, including anything it's grown by
+ */
+void
+shmema_usage(shmema_usage_t *up)
+{
+    size_t used, avail, largest;
+    int i;
+
+    mspace_usage(myspace, &up->used, &up->free, &up->largest_free);
+    up->capacity = mycapacity;
+
+    for (i = 0; i < nextensions; ++i) {
+        mspace_usage(extensions[i].space, &used, &avail, &largest);
+
+        up->capacity += extensions[i].end - extensions[i].base;
+        up->used += used;
+        up->free += avail;
+        if (largest > up->largest_free) {
+            up->largest_free = largest;
+        }
+    }
 
-    return aligned_addr;
+    up->blocks = nblocks;
+    up->allocs = nallocs;
+    up->peak = peak;
 }
@@ -5,16 +5,37 @@
 
 #include <sys/types.h>          /* size_t */
 
+/*
+ * what's in a heap.  "used" and "free" include allocator overhead,
+ * "peak" is what was handed out.
+ */
+typedef struct shmema_usage {
+    size_t capacity;            /* bytes managed */
+    size_t used;                /* bytes in use */
+    size_t free;                /* bytes free */
+    size_t largest_free;        /* biggest free block */
+    size_t blocks;              /* blocks allocated now */
+    size_t allocs;              /* allocations so far */
+    size_t peak;                /* most bytes allocated at once */
+} shmema_usage_t;
+
 /*
  * memory allocation
  */
 void shmema_init(void *base, size_t capacity);
 void shmema_finalize(void);
+int shmema_extend(void *base, size_t capacity);
 void *shmema_base(void);
 void *shmema_malloc(size_t size);
 void *shmema_calloc(size_t count, size_t size);
 void shmema_free(void *addr);
+int shmema_free_deferred(void *addr);
+size_t shmema_deferred(void);
+void shmema_reclaim(void);
 void *shmema_realloc(void *addr, size_t new_size);
 void *shmema_align(size_t alignment, size_t size);
+size_t shmema_usable_size(void *addr);
+
+void shmema_usage(shmema_usage_t *up);
 
 #endif /* ! _SHMEMA_MEMALLOC_H */
@@ -10,6 +10,54 @@
 
 static mspace *spaces;
 
+/*
+ * extent of heaps we manage here (not the shared default one), to
+ * find which heap an address is in
+ */
+static char **bases = NULL;
+static char **ends;
+
+/*
+ * running counts per heap, for usage reports
+ */
+typedef struct heap_counts {
+    size_t blocks;
+    size_t allocs;
+    size_t live;
+    size_t peak;
+} heap_counts_t;
+
+static heap_counts_t *counts;
+
+/*
+ * the default heap belongs to shmema, which knows about its growth
+ * extensions and keeps its counts: hand its allocations over
+ */
+static shmemx_heap_index_t shared = -1;
+
+inline static void
+count_resize(shmemx_heap_index_t index, size_t old_size, size_t new_size)
+{
+    heap_counts_t *cp = & counts[index];
+
+    cp->live = cp->live - old_size + new_size;
+    if (cp->live > cp->peak) {
+        cp->peak = cp->live;
+    }
+}
+
+inline static void *
+count_alloc(shmemx_heap_index_t index, void *addr)
+{
+    if (addr != NULL) {
+        ++counts[index].blocks;
+        ++counts[index].allocs;
+        count_resize(index, 0, mspace_usable_size(addr));
+    }
+
+    return addr;
+}
+
 /*
  * map named heap to its index
  */
@@ -18,10 +66,8 @@ KHASH_MAP_INIT_STR(heapnames, shmemx_heap_index_t)
 
 static khash_t(heapnames) *names;
 
-static shmemx_heap_index_t idx = 0;
-
 /*
- * translate between name and index (create if needed)
+ * translate between name and index
  */
 
 inline static shmemx_heap_index_t
@@ -37,37 +83,22 @@ lookup_name(const char *name)
     }
 }
 
-inline static shmemx_heap_index_t
-record_name(const char *name)
+inline static void
+record_name(const char *name, shmemx_heap_index_t index)
 {
     int there;
     khiter_t k;
-    const shmemx_heap_index_t mine = idx;
 
     k = kh_put(heapnames, names, name, &there);
-    if (there != 1) {
-        return -1;
-        /* NOT REACHED */
-    }
-
-    kh_value(names, k) = mine;
-
-    ++idx;
+    assert(there == 1);
 
-    return mine;
+    kh_value(names, k) = index;
 }
 
 shmemx_heap_index_t
 shmemxa_name_to_index(const char *name)
 {
-    const shmemx_heap_index_t i = lookup_name(name);
-
-    if (i == -1) {
-        return record_name(name);
-    }
-    else {
-        return i;
-    }
+    return lookup_name(name);
 }
 
 char *
@@ -100,13 +131,36 @@ shmemxa_init(shmemx_heap_index_t numheaps)
 
     assert(spaces != NULL);
 
+    bases = (char **) calloc(numheaps, sizeof(*bases));
+    ends = (char **) calloc(numheaps, sizeof(*ends));
+
+    assert((bases != NULL) && (ends != NULL));
+
+    counts = (heap_counts_t *) calloc(numheaps, sizeof(*counts));
+
+    assert(counts != NULL);
+
+    names = kh_init(heapnames);
+
+    assert(names != NULL);
+
     nheaps = numheaps;
 }
 
 void
 shmemxa_finalize(void)
 {
+    kh_destroy(heapnames, names);
+
     free(spaces);
+
+    free(bases);
+    free(ends);
+    bases = NULL;
+
+    free(counts);
+
+    shared = -1;
 }
 
 /*
@@ -114,18 +168,68 @@ shmemxa_finalize(void)
  */
 
 void
-shmemxa_init_by_index(shmemx_heap_index_t index,
+shmemxa_init_by_index(shmemx_heap_index_t index, const char *name,
                       void *base, size_t capacity)
 {
+    record_name(name, index);
+
     spaces[index] = create_mspace_with_base(base, capacity, 1);
+
+    bases[index] = (char *) base;
+    ends[index] = bases[index] + capacity;
+}
+
+/*
+ * heap already managed elsewhere (the default one)
+ */
+
+void
+shmemxa_share_by_index(shmemx_heap_index_t index, const char *name,
+                       void *space)
+{
+    record_name(name, index);
+
+    spaces[index] = space;
+    shared = index;
 }
 
 void
 shmemxa_finalize_by_index(shmemx_heap_index_t index)
 {
+    if (index == shared) {
+        return;
+        /* NOT REACHED */
+    }
+
     destroy_mspace(spaces[index]);
 }
 
+/*
+ * which of our heaps is ADDR in?  -1 if none (including the default
+ * heap, which isn't ours)
+ */
+
+shmemx_heap_index_t
+shmemxa_addr_to_index(const void *addr)
+{
+    const char *a = (const char *) addr;
+    shmemx_heap_index_t i;
+
+    if (bases == NULL) {
+        return -1;
+        /* NOT REACHED */
+    }
+
+    for (i = 0; i < nheaps; ++i) {
+        if ((bases[i] != NULL) && (bases[i] <= a) && (a < ends[i])) {
+            return i;
+            /* NOT REACHED */
+        }
+    }
+
+    return -1;
+}
+
 /*
  * heap allocations
  */
@@ -140,20 +244,41 @@ void *
 shmemxa_malloc_by_index(shmemx_heap_index_t index,
                         size_t size)
 {
-    return mspace_malloc(spaces[index], size);
+    if (index == shared) {
+        return shmema_malloc(size);
+        /* NOT REACHED */
+    }
+
+    return count_alloc(index, mspace_malloc(spaces[index], size));
 }
 
 void *
 shmemxa_calloc_by_index(shmemx_heap_index_t index,
                         size_t count, size_t size)
 {
-    return mspace_calloc(spaces[index], count, size);
+    if (index == shared) {
+        return shmema_calloc(count, size);
+        /* NOT REACHED */
+    }
+
+    return count_alloc(index, mspace_calloc(spaces[index], count, size));
 }
 
 void
 shmemxa_free_by_index(shmemx_heap_index_t index,
                       void *addr)
 {
+    if (index == shared) {
+        shmema_free(addr);
+        return;
+        /* NOT REACHED */
+    }
+
+    if (addr != NULL) {
+        --counts[index].blocks;
+        count_resize(index, mspace_usable_size(addr), 0);
+    }
+
     mspace_free(spaces[index], addr);
 }
 
@@ -161,12 +286,67 @@ void *
 shmemxa_realloc_by_index(shmemx_heap_index_t index,
                          void *addr, size_t new_size)
 {
-    return mspace_realloc(spaces[index], addr, new_size);
+    size_t old_size;
+    void *new_addr;
+
+    if (index == shared) {
+        return shmema_realloc(addr, new_size);
+        /* NOT REACHED */
+    }
+
+    old_size = mspace_usable_size(addr); /* 0 if NULL */
+    new_addr = mspace_realloc(spaces[index], addr, new_size);
+
+    if (addr == NULL) {
+        return count_alloc(index, new_addr);
+        /* NOT REACHED */
+    }
+
+    if (new_addr != NULL) {
+        count_resize(index, old_size, mspace_usable_size(new_addr));
+    }
+    else if (new_size == 0) {
+        /* realloc to 0 frees */
+        --counts[index].blocks;
+        count_resize(index, old_size, 0);
+    }
+
+    return new_addr;
 }
 
 void *
 shmemxa_align_by_index(shmemx_heap_index_t index,
                        size_t alignment, size_t size)
 {
-    return mspace_memalign(spaces[index], alignment, size);
+    if (index == shared) {
+        return shmema_align(alignment, size);
+        /* NOT REACHED */
+    }
+
+    return count_alloc(index,
+                       mspace_memalign(spaces[index], alignment, size));
+}
+
+/*
+ * usage of one of our heaps.  Counts only cover allocations made
+ * through here.
+ */
+
+void
+shmemxa_usage_by_index(shmemx_heap_index_t index, shmema_usage_t *up)
+{
+    const heap_counts_t *cp = & counts[index];
+
+    if (index == shared) {
+        shmema_usage(up);
+        return;
+        /* NOT REACHED */
+    }
+
+    mspace_usage(spaces[index], &up->used, &up->free, &up->largest_free);
+
+    up->capacity = ends[index] - bases[index];
+    up->blocks = cp->blocks;
+    up->allocs = cp->allocs;
+    up->peak = cp->peak;
 }
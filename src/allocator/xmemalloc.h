@@ -3,6 +3,8 @@
 #ifndef _SHMEMXA_MEMALLOC_H
 #define _SHMEMXA_MEMALLOC_H 1
 
+#include "memalloc.h"           /* shmema_usage_t */
+
 #include <sys/types.h>          /* size_t */
 
 /*
@@ -20,10 +22,15 @@ char *shmemxa_index_to_name(shmemx_heap_index_t index);
 void shmemxa_init(shmemx_heap_index_t numheaps);
 void shmemxa_finalize(void);
 
-void shmemxa_init_by_index(shmemx_heap_index_t index,
+void shmemxa_init_by_index(shmemx_heap_index_t index, const char *name,
                            void *base, size_t capacity);
+void shmemxa_share_by_index(shmemx_heap_index_t index, const char *name,
+                            void *space);
 void shmemxa_finalize_by_index(shmemx_heap_index_t index);
 
+shmemx_heap_index_t shmemxa_addr_to_index(const void *addr);
+void shmemxa_usage_by_index(shmemx_heap_index_t index, shmema_usage_t *up);
+
 void *shmemxa_base_by_index(shmemx_heap_index_t index);
 void *shmemxa_malloc_by_index(shmemx_heap_index_t index,
                               size_t size);
@@ -1247,3 +1247,632 @@ API_DEF_VOID_AMO2(and, int32, int32_t)
 API_DEF_VOID_AMO2(and, int64, int64_t)
 API_DEF_VOID_AMO2(and, uint32, uint32_t)
 API_DEF_VOID_AMO2(and, uint64, uint64_t)
+
+/* ------------------------------------------------------------------------ */
+
+/*
+ * non-blocking fetching AMOs: the fetched value is only guaranteed to
+ * be in "fetch" after a quiet on the context
+ */
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_ctx_int_atomic_fetch_add_nbi = pshmem_ctx_int_atomic_fetch_add_nbi
+#define shmem_ctx_int_atomic_fetch_add_nbi pshmem_ctx_int_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_long_atomic_fetch_add_nbi = pshmem_ctx_long_atomic_fetch_add_nbi
+#define shmem_ctx_long_atomic_fetch_add_nbi pshmem_ctx_long_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_longlong_atomic_fetch_add_nbi = pshmem_ctx_longlong_atomic_fetch_add_nbi
+#define shmem_ctx_longlong_atomic_fetch_add_nbi pshmem_ctx_longlong_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_uint_atomic_fetch_add_nbi = pshmem_ctx_uint_atomic_fetch_add_nbi
+#define shmem_ctx_uint_atomic_fetch_add_nbi pshmem_ctx_uint_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_ulong_atomic_fetch_add_nbi = pshmem_ctx_ulong_atomic_fetch_add_nbi
+#define shmem_ctx_ulong_atomic_fetch_add_nbi pshmem_ctx_ulong_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_ulonglong_atomic_fetch_add_nbi = pshmem_ctx_ulonglong_atomic_fetch_add_nbi
+#define shmem_ctx_ulonglong_atomic_fetch_add_nbi pshmem_ctx_ulonglong_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_int32_atomic_fetch_add_nbi = pshmem_ctx_int32_atomic_fetch_add_nbi
+#define shmem_ctx_int32_atomic_fetch_add_nbi pshmem_ctx_int32_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_int64_atomic_fetch_add_nbi = pshmem_ctx_int64_atomic_fetch_add_nbi
+#define shmem_ctx_int64_atomic_fetch_add_nbi pshmem_ctx_int64_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_uint32_atomic_fetch_add_nbi = pshmem_ctx_uint32_atomic_fetch_add_nbi
+#define shmem_ctx_uint32_atomic_fetch_add_nbi pshmem_ctx_uint32_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_uint64_atomic_fetch_add_nbi = pshmem_ctx_uint64_atomic_fetch_add_nbi
+#define shmem_ctx_uint64_atomic_fetch_add_nbi pshmem_ctx_uint64_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_size_atomic_fetch_add_nbi = pshmem_ctx_size_atomic_fetch_add_nbi
+#define shmem_ctx_size_atomic_fetch_add_nbi pshmem_ctx_size_atomic_fetch_add_nbi
+#pragma weak shmem_ctx_ptrdiff_atomic_fetch_add_nbi = pshmem_ctx_ptrdiff_atomic_fetch_add_nbi
+#define shmem_ctx_ptrdiff_atomic_fetch_add_nbi pshmem_ctx_ptrdiff_atomic_fetch_add_nbi
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * fetch-and-add
+ */
+
+#define SHMEM_CTX_TYPE_FADD_NBI(_name, _type)                           \
+    void                                                                \
+    shmem_ctx_##_name##_atomic_fetch_add_nbi(shmem_ctx_t ctx,           \
+                                             _type *fetch,              \
+                                             _type *target,             \
+                                             _type value, int pe)       \
+    {                                                                   \
+        SHMEMU_CHECK_INIT();                                            \
+        SHMEMU_CHECK_SYMMETRIC(target, 3);                              \
+                                                                        \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_fadd_nbi(ctx,                 \
+                                                   target,              \
+                                                   &value,              \
+                                                   sizeof(value),       \
+                                                   pe, fetch));         \
+    }
+
+SHMEM_CTX_TYPE_FADD_NBI(int, int)
+SHMEM_CTX_TYPE_FADD_NBI(long, long)
+SHMEM_CTX_TYPE_FADD_NBI(longlong, long long)
+SHMEM_CTX_TYPE_FADD_NBI(uint, unsigned int)
+SHMEM_CTX_TYPE_FADD_NBI(ulong, unsigned long)
+SHMEM_CTX_TYPE_FADD_NBI(ulonglong, unsigned long long)
+SHMEM_CTX_TYPE_FADD_NBI(int32, int32_t)
+SHMEM_CTX_TYPE_FADD_NBI(int64, int64_t)
+SHMEM_CTX_TYPE_FADD_NBI(uint32, uint32_t)
+SHMEM_CTX_TYPE_FADD_NBI(uint64, uint64_t)
+SHMEM_CTX_TYPE_FADD_NBI(size, size_t)
+SHMEM_CTX_TYPE_FADD_NBI(ptrdiff, ptrdiff_t)
+
+#undef SHMEM_CTX_TYPE_FADD_NBI
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_ctx_int_atomic_fetch_inc_nbi = pshmem_ctx_int_atomic_fetch_inc_nbi
+#define shmem_ctx_int_atomic_fetch_inc_nbi pshmem_ctx_int_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_long_atomic_fetch_inc_nbi = pshmem_ctx_long_atomic_fetch_inc_nbi
+#define shmem_ctx_long_atomic_fetch_inc_nbi pshmem_ctx_long_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_longlong_atomic_fetch_inc_nbi = pshmem_ctx_longlong_atomic_fetch_inc_nbi
+#define shmem_ctx_longlong_atomic_fetch_inc_nbi pshmem_ctx_longlong_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_uint_atomic_fetch_inc_nbi = pshmem_ctx_uint_atomic_fetch_inc_nbi
+#define shmem_ctx_uint_atomic_fetch_inc_nbi pshmem_ctx_uint_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_ulong_atomic_fetch_inc_nbi = pshmem_ctx_ulong_atomic_fetch_inc_nbi
+#define shmem_ctx_ulong_atomic_fetch_inc_nbi pshmem_ctx_ulong_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_ulonglong_atomic_fetch_inc_nbi = pshmem_ctx_ulonglong_atomic_fetch_inc_nbi
+#define shmem_ctx_ulonglong_atomic_fetch_inc_nbi pshmem_ctx_ulonglong_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_int32_atomic_fetch_inc_nbi = pshmem_ctx_int32_atomic_fetch_inc_nbi
+#define shmem_ctx_int32_atomic_fetch_inc_nbi pshmem_ctx_int32_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_int64_atomic_fetch_inc_nbi = pshmem_ctx_int64_atomic_fetch_inc_nbi
+#define shmem_ctx_int64_atomic_fetch_inc_nbi pshmem_ctx_int64_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_uint32_atomic_fetch_inc_nbi = pshmem_ctx_uint32_atomic_fetch_inc_nbi
+#define shmem_ctx_uint32_atomic_fetch_inc_nbi pshmem_ctx_uint32_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_uint64_atomic_fetch_inc_nbi = pshmem_ctx_uint64_atomic_fetch_inc_nbi
+#define shmem_ctx_uint64_atomic_fetch_inc_nbi pshmem_ctx_uint64_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_size_atomic_fetch_inc_nbi = pshmem_ctx_size_atomic_fetch_inc_nbi
+#define shmem_ctx_size_atomic_fetch_inc_nbi pshmem_ctx_size_atomic_fetch_inc_nbi
+#pragma weak shmem_ctx_ptrdiff_atomic_fetch_inc_nbi = pshmem_ctx_ptrdiff_atomic_fetch_inc_nbi
+#define shmem_ctx_ptrdiff_atomic_fetch_inc_nbi pshmem_ctx_ptrdiff_atomic_fetch_inc_nbi
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * fetch-and-increment
+ */
+
+#define SHMEM_CTX_TYPE_FINC_NBI(_name, _type)                           \
+    void                                                                \
+    shmem_ctx_##_name##_atomic_fetch_inc_nbi(shmem_ctx_t ctx,           \
+                                             _type *fetch,              \
+                                             _type *target,             \
+                                             int pe)                    \
+    {                                                                   \
+        _type one = 1;                                                  \
+                                                                        \
+        SHMEMU_CHECK_INIT();                                            \
+        SHMEMU_CHECK_SYMMETRIC(target, 3);                              \
+                                                                        \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_fadd_nbi(ctx,                 \
+                                                   target,              \
+                                                   &one, sizeof(one),   \
+                                                   pe, fetch));         \
+    }
+
+SHMEM_CTX_TYPE_FINC_NBI(int, int)
+SHMEM_CTX_TYPE_FINC_NBI(long, long)
+SHMEM_CTX_TYPE_FINC_NBI(longlong, long long)
+SHMEM_CTX_TYPE_FINC_NBI(uint, unsigned int)
+SHMEM_CTX_TYPE_FINC_NBI(ulong, unsigned long)
+SHMEM_CTX_TYPE_FINC_NBI(ulonglong, unsigned long long)
+SHMEM_CTX_TYPE_FINC_NBI(int32, int32_t)
+SHMEM_CTX_TYPE_FINC_NBI(int64, int64_t)
+SHMEM_CTX_TYPE_FINC_NBI(uint32, uint32_t)
+SHMEM_CTX_TYPE_FINC_NBI(uint64, uint64_t)
+SHMEM_CTX_TYPE_FINC_NBI(size, size_t)
+SHMEM_CTX_TYPE_FINC_NBI(ptrdiff, ptrdiff_t)
+
+#undef SHMEM_CTX_TYPE_FINC_NBI
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_ctx_float_atomic_swap_nbi = pshmem_ctx_float_atomic_swap_nbi
+#define shmem_ctx_float_atomic_swap_nbi pshmem_ctx_float_atomic_swap_nbi
+#pragma weak shmem_ctx_double_atomic_swap_nbi = pshmem_ctx_double_atomic_swap_nbi
+#define shmem_ctx_double_atomic_swap_nbi pshmem_ctx_double_atomic_swap_nbi
+#pragma weak shmem_ctx_int_atomic_swap_nbi = pshmem_ctx_int_atomic_swap_nbi
+#define shmem_ctx_int_atomic_swap_nbi pshmem_ctx_int_atomic_swap_nbi
+#pragma weak shmem_ctx_long_atomic_swap_nbi = pshmem_ctx_long_atomic_swap_nbi
+#define shmem_ctx_long_atomic_swap_nbi pshmem_ctx_long_atomic_swap_nbi
+#pragma weak shmem_ctx_longlong_atomic_swap_nbi = pshmem_ctx_longlong_atomic_swap_nbi
+#define shmem_ctx_longlong_atomic_swap_nbi pshmem_ctx_longlong_atomic_swap_nbi
+#pragma weak shmem_ctx_uint_atomic_swap_nbi = pshmem_ctx_uint_atomic_swap_nbi
+#define shmem_ctx_uint_atomic_swap_nbi pshmem_ctx_uint_atomic_swap_nbi
+#pragma weak shmem_ctx_ulong_atomic_swap_nbi = pshmem_ctx_ulong_atomic_swap_nbi
+#define shmem_ctx_ulong_atomic_swap_nbi pshmem_ctx_ulong_atomic_swap_nbi
+#pragma weak shmem_ctx_ulonglong_atomic_swap_nbi = pshmem_ctx_ulonglong_atomic_swap_nbi
+#define shmem_ctx_ulonglong_atomic_swap_nbi pshmem_ctx_ulonglong_atomic_swap_nbi
+#pragma weak shmem_ctx_int32_atomic_swap_nbi = pshmem_ctx_int32_atomic_swap_nbi
+#define shmem_ctx_int32_atomic_swap_nbi pshmem_ctx_int32_atomic_swap_nbi
+#pragma weak shmem_ctx_int64_atomic_swap_nbi = pshmem_ctx_int64_atomic_swap_nbi
+#define shmem_ctx_int64_atomic_swap_nbi pshmem_ctx_int64_atomic_swap_nbi
+#pragma weak shmem_ctx_uint32_atomic_swap_nbi = pshmem_ctx_uint32_atomic_swap_nbi
+#define shmem_ctx_uint32_atomic_swap_nbi pshmem_ctx_uint32_atomic_swap_nbi
+#pragma weak shmem_ctx_uint64_atomic_swap_nbi = pshmem_ctx_uint64_atomic_swap_nbi
+#define shmem_ctx_uint64_atomic_swap_nbi pshmem_ctx_uint64_atomic_swap_nbi
+#pragma weak shmem_ctx_size_atomic_swap_nbi = pshmem_ctx_size_atomic_swap_nbi
+#define shmem_ctx_size_atomic_swap_nbi pshmem_ctx_size_atomic_swap_nbi
+#pragma weak shmem_ctx_ptrdiff_atomic_swap_nbi = pshmem_ctx_ptrdiff_atomic_swap_nbi
+#define shmem_ctx_ptrdiff_atomic_swap_nbi pshmem_ctx_ptrdiff_atomic_swap_nbi
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * swap
+ */
+
+#define SHMEM_CTX_TYPE_SWAP_NBI(_name, _type)                           \
+    void                                                                \
+    shmem_ctx_##_name##_atomic_swap_nbi(shmem_ctx_t ctx,                \
+                                        _type *fetch,                   \
+                                        _type *target,                  \
+                                        _type value, int pe)            \
+    {                                                                   \
+        SHMEMU_CHECK_INIT();                                            \
+        SHMEMU_CHECK_SYMMETRIC(target, 3);                              \
+                                                                        \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_swap_nbi(ctx,                 \
+                                                   target,              \
+                                                   &value,              \
+                                                   sizeof(value),       \
+                                                   pe, fetch));         \
+    }
+
+SHMEM_CTX_TYPE_SWAP_NBI(float, float)
+SHMEM_CTX_TYPE_SWAP_NBI(double, double)
+SHMEM_CTX_TYPE_SWAP_NBI(int, int)
+SHMEM_CTX_TYPE_SWAP_NBI(long, long)
+SHMEM_CTX_TYPE_SWAP_NBI(longlong, long long)
+SHMEM_CTX_TYPE_SWAP_NBI(uint, unsigned int)
+SHMEM_CTX_TYPE_SWAP_NBI(ulong, unsigned long)
+SHMEM_CTX_TYPE_SWAP_NBI(ulonglong, unsigned long long)
+SHMEM_CTX_TYPE_SWAP_NBI(int32, int32_t)
+SHMEM_CTX_TYPE_SWAP_NBI(int64, int64_t)
+SHMEM_CTX_TYPE_SWAP_NBI(uint32, uint32_t)
+SHMEM_CTX_TYPE_SWAP_NBI(uint64, uint64_t)
+SHMEM_CTX_TYPE_SWAP_NBI(size, size_t)
+SHMEM_CTX_TYPE_SWAP_NBI(ptrdiff, ptrdiff_t)
+
+#undef SHMEM_CTX_TYPE_SWAP_NBI
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_ctx_int_atomic_compare_swap_nbi = pshmem_ctx_int_atomic_compare_swap_nbi
+#define shmem_ctx_int_atomic_compare_swap_nbi pshmem_ctx_int_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_long_atomic_compare_swap_nbi = pshmem_ctx_long_atomic_compare_swap_nbi
+#define shmem_ctx_long_atomic_compare_swap_nbi pshmem_ctx_long_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_longlong_atomic_compare_swap_nbi = pshmem_ctx_longlong_atomic_compare_swap_nbi
+#define shmem_ctx_longlong_atomic_compare_swap_nbi pshmem_ctx_longlong_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_uint_atomic_compare_swap_nbi = pshmem_ctx_uint_atomic_compare_swap_nbi
+#define shmem_ctx_uint_atomic_compare_swap_nbi pshmem_ctx_uint_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_ulong_atomic_compare_swap_nbi = pshmem_ctx_ulong_atomic_compare_swap_nbi
+#define shmem_ctx_ulong_atomic_compare_swap_nbi pshmem_ctx_ulong_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_ulonglong_atomic_compare_swap_nbi = pshmem_ctx_ulonglong_atomic_compare_swap_nbi
+#define shmem_ctx_ulonglong_atomic_compare_swap_nbi pshmem_ctx_ulonglong_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_int32_atomic_compare_swap_nbi = pshmem_ctx_int32_atomic_compare_swap_nbi
+#define shmem_ctx_int32_atomic_compare_swap_nbi pshmem_ctx_int32_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_int64_atomic_compare_swap_nbi = pshmem_ctx_int64_atomic_compare_swap_nbi
+#define shmem_ctx_int64_atomic_compare_swap_nbi pshmem_ctx_int64_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_uint32_atomic_compare_swap_nbi = pshmem_ctx_uint32_atomic_compare_swap_nbi
+#define shmem_ctx_uint32_atomic_compare_swap_nbi pshmem_ctx_uint32_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_uint64_atomic_compare_swap_nbi = pshmem_ctx_uint64_atomic_compare_swap_nbi
+#define shmem_ctx_uint64_atomic_compare_swap_nbi pshmem_ctx_uint64_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_size_atomic_compare_swap_nbi = pshmem_ctx_size_atomic_compare_swap_nbi
+#define shmem_ctx_size_atomic_compare_swap_nbi pshmem_ctx_size_atomic_compare_swap_nbi
+#pragma weak shmem_ctx_ptrdiff_atomic_compare_swap_nbi = pshmem_ctx_ptrdiff_atomic_compare_swap_nbi
+#define shmem_ctx_ptrdiff_atomic_compare_swap_nbi pshmem_ctx_ptrdiff_atomic_compare_swap_nbi
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * conditional swap
+ */
+
+#define SHMEM_CTX_TYPE_CSWAP_NBI(_name, _type)                          \
+    void                                                                \
+    shmem_ctx_##_name##_atomic_compare_swap_nbi(shmem_ctx_t ctx,        \
+                                                _type *fetch,           \
+                                                _type *target,          \
+                                                _type cond,             \
+                                                _type value,            \
+                                                int pe)                 \
+    {                                                                   \
+        SHMEMU_CHECK_INIT();                                            \
+        SHMEMU_CHECK_SYMMETRIC(target, 3);                              \
+                                                                        \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_cswap_nbi(ctx,                \
+                                                    target,             \
+                                                    &cond,              \
+                                                    &value,             \
+                                                    sizeof(value),      \
+                                                    pe, fetch));        \
+    }
+
+SHMEM_CTX_TYPE_CSWAP_NBI(int, int)
+SHMEM_CTX_TYPE_CSWAP_NBI(long, long)
+SHMEM_CTX_TYPE_CSWAP_NBI(longlong, long long)
+SHMEM_CTX_TYPE_CSWAP_NBI(uint, unsigned int)
+SHMEM_CTX_TYPE_CSWAP_NBI(ulong, unsigned long)
+SHMEM_CTX_TYPE_CSWAP_NBI(ulonglong, unsigned long long)
+SHMEM_CTX_TYPE_CSWAP_NBI(int32, int32_t)
+SHMEM_CTX_TYPE_CSWAP_NBI(int64, int64_t)
+SHMEM_CTX_TYPE_CSWAP_NBI(uint32, uint32_t)
+SHMEM_CTX_TYPE_CSWAP_NBI(uint64, uint64_t)
+SHMEM_CTX_TYPE_CSWAP_NBI(size, size_t)
+SHMEM_CTX_TYPE_CSWAP_NBI(ptrdiff, ptrdiff_t)
+
+#undef SHMEM_CTX_TYPE_CSWAP_NBI
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_ctx_uint_atomic_fetch_xor_nbi = pshmem_ctx_uint_atomic_fetch_xor_nbi
+#define shmem_ctx_uint_atomic_fetch_xor_nbi pshmem_ctx_uint_atomic_fetch_xor_nbi
+#pragma weak shmem_ctx_ulong_atomic_fetch_xor_nbi = pshmem_ctx_ulong_atomic_fetch_xor_nbi
+#define shmem_ctx_ulong_atomic_fetch_xor_nbi pshmem_ctx_ulong_atomic_fetch_xor_nbi
+#pragma weak shmem_ctx_ulonglong_atomic_fetch_xor_nbi = pshmem_ctx_ulonglong_atomic_fetch_xor_nbi
+#define shmem_ctx_ulonglong_atomic_fetch_xor_nbi pshmem_ctx_ulonglong_atomic_fetch_xor_nbi
+#pragma weak shmem_ctx_int32_atomic_fetch_xor_nbi = pshmem_ctx_int32_atomic_fetch_xor_nbi
+#define shmem_ctx_int32_atomic_fetch_xor_nbi pshmem_ctx_int32_atomic_fetch_xor_nbi
+#pragma weak shmem_ctx_int64_atomic_fetch_xor_nbi = pshmem_ctx_int64_atomic_fetch_xor_nbi
+#define shmem_ctx_int64_atomic_fetch_xor_nbi pshmem_ctx_int64_atomic_fetch_xor_nbi
+#pragma weak shmem_ctx_uint32_atomic_fetch_xor_nbi = pshmem_ctx_uint32_atomic_fetch_xor_nbi
+#define shmem_ctx_uint32_atomic_fetch_xor_nbi pshmem_ctx_uint32_atomic_fetch_xor_nbi
+#pragma weak shmem_ctx_uint64_atomic_fetch_xor_nbi = pshmem_ctx_uint64_atomic_fetch_xor_nbi
+#define shmem_ctx_uint64_atomic_fetch_xor_nbi pshmem_ctx_uint64_atomic_fetch_xor_nbi
+#pragma weak shmem_ctx_uint_atomic_fetch_or_nbi = pshmem_ctx_uint_atomic_fetch_or_nbi
+#define shmem_ctx_uint_atomic_fetch_or_nbi pshmem_ctx_uint_atomic_fetch_or_nbi
+#pragma weak shmem_ctx_ulong_atomic_fetch_or_nbi = pshmem_ctx_ulong_atomic_fetch_or_nbi
+#define shmem_ctx_ulong_atomic_fetch_or_nbi pshmem_ctx_ulong_atomic_fetch_or_nbi
+#pragma weak shmem_ctx_ulonglong_atomic_fetch_or_nbi = pshmem_ctx_ulonglong_atomic_fetch_or_nbi
+#define shmem_ctx_ulonglong_atomic_fetch_or_nbi pshmem_ctx_ulonglong_atomic_fetch_or_nbi
+#pragma weak shmem_ctx_int32_atomic_fetch_or_nbi = pshmem_ctx_int32_atomic_fetch_or_nbi
+#define shmem_ctx_int32_atomic_fetch_or_nbi pshmem_ctx_int32_atomic_fetch_or_nbi
+#pragma weak shmem_ctx_int64_atomic_fetch_or_nbi = pshmem_ctx_int64_atomic_fetch_or_nbi
+#define shmem_ctx_int64_atomic_fetch_or_nbi pshmem_ctx_int64_atomic_fetch_or_nbi
+#pragma weak shmem_ctx_uint32_atomic_fetch_or_nbi = pshmem_ctx_uint32_atomic_fetch_or_nbi
+#define shmem_ctx_uint32_atomic_fetch_or_nbi pshmem_ctx_uint32_atomic_fetch_or_nbi
+#pragma weak shmem_ctx_uint64_atomic_fetch_or_nbi = pshmem_ctx_uint64_atomic_fetch_or_nbi
+#define shmem_ctx_uint64_atomic_fetch_or_nbi pshmem_ctx_uint64_atomic_fetch_or_nbi
+#pragma weak shmem_ctx_uint_atomic_fetch_and_nbi = pshmem_ctx_uint_atomic_fetch_and_nbi
+#define shmem_ctx_uint_atomic_fetch_and_nbi pshmem_ctx_uint_atomic_fetch_and_nbi
+#pragma weak shmem_ctx_ulong_atomic_fetch_and_nbi = pshmem_ctx_ulong_atomic_fetch_and_nbi
+#define shmem_ctx_ulong_atomic_fetch_and_nbi pshmem_ctx_ulong_atomic_fetch_and_nbi
+#pragma weak shmem_ctx_ulonglong_atomic_fetch_and_nbi = pshmem_ctx_ulonglong_atomic_fetch_and_nbi
+#define shmem_ctx_ulonglong_atomic_fetch_and_nbi pshmem_ctx_ulonglong_atomic_fetch_and_nbi
+#pragma weak shmem_ctx_int32_atomic_fetch_and_nbi = pshmem_ctx_int32_atomic_fetch_and_nbi
+#define shmem_ctx_int32_atomic_fetch_and_nbi pshmem_ctx_int32_atomic_fetch_and_nbi
+#pragma weak shmem_ctx_int64_atomic_fetch_and_nbi = pshmem_ctx_int64_atomic_fetch_and_nbi
+#define shmem_ctx_int64_atomic_fetch_and_nbi pshmem_ctx_int64_atomic_fetch_and_nbi
+#pragma weak shmem_ctx_uint32_atomic_fetch_and_nbi = pshmem_ctx_uint32_atomic_fetch_and_nbi
+#define shmem_ctx_uint32_atomic_fetch_and_nbi pshmem_ctx_uint32_atomic_fetch_and_nbi
+#pragma weak shmem_ctx_uint64_atomic_fetch_and_nbi = pshmem_ctx_uint64_atomic_fetch_and_nbi
+#define shmem_ctx_uint64_atomic_fetch_and_nbi pshmem_ctx_uint64_atomic_fetch_and_nbi
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * fetch-bitwise
+ */
+
+#define SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(_opname, _name, _type)         \
+    void                                                                \
+    shmem_ctx_##_name##_atomic_fetch_##_opname##_nbi(shmem_ctx_t ctx,   \
+                                                     _type *fetch,      \
+                                                     _type *target,     \
+                                                     _type value,       \
+                                                     int pe)            \
+    {                                                                   \
+        SHMEMU_CHECK_INIT();                                            \
+        SHMEMU_CHECK_SYMMETRIC(target, 3);                              \
+                                                                        \
+        SHMEMT_MUTEX_NOPROTECT(                                         \
+            shmemc_ctx_fetch_##_opname##_nbi(ctx, target,               \
+                                             &value, sizeof(value),     \
+                                             pe, fetch));               \
+    }
+
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(xor, uint, unsigned int)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(xor, ulong, unsigned long)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(xor, ulonglong, unsigned long long)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(xor, int32, int32_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(xor, int64, int64_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(xor, uint32, uint32_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(xor, uint64, uint64_t)
+
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(or, uint, unsigned int)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(or, ulong, unsigned long)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(or, ulonglong, unsigned long long)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(or, int32, int32_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(or, int64, int64_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(or, uint32, uint32_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(or, uint64, uint64_t)
+
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(and, uint, unsigned int)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(and, ulong, unsigned long)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(and, ulonglong, unsigned long long)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(and, int32, int32_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(and, int64, int64_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(and, uint32, uint32_t)
+SHMEM_CTX_TYPE_FETCH_BITWISE_NBI(and, uint64, uint64_t)
+
+#undef SHMEM_CTX_TYPE_FETCH_BITWISE_NBI
+
+#define API_DEF_AMO1_NBI(_op, _name, _type)                             \
+    void shmem_##_name##_atomic_##_op##_nbi(_type *fetch,               \
+                                            _type *target, int pe)      \
+    {                                                                   \
+        shmem_ctx_##_name##_atomic_##_op##_nbi(SHMEM_CTX_DEFAULT,       \
+                                               fetch, target, pe);      \
+    }
+
+#define API_DEF_AMO2_NBI(_op, _name, _type)                             \
+    void shmem_##_name##_atomic_##_op##_nbi(_type *fetch,               \
+                                            _type *target,              \
+                                            _type value, int pe)        \
+    {                                                                   \
+        shmem_ctx_##_name##_atomic_##_op##_nbi(SHMEM_CTX_DEFAULT,       \
+                                               fetch, target,           \
+                                               value, pe);              \
+    }
+
+#define API_DEF_AMO3_NBI(_op, _name, _type)                             \
+    void shmem_##_name##_atomic_##_op##_nbi(_type *fetch,               \
+                                            _type *target,              \
+                                            _type cond, _type value,    \
+                                            int pe)                     \
+    {                                                                   \
+        shmem_ctx_##_name##_atomic_##_op##_nbi(SHMEM_CTX_DEFAULT,       \
+                                               fetch, target,           \
+                                               cond, value, pe);        \
+    }
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_int_atomic_fetch_inc_nbi = pshmem_int_atomic_fetch_inc_nbi
+#define shmem_int_atomic_fetch_inc_nbi pshmem_int_atomic_fetch_inc_nbi
+#pragma weak shmem_long_atomic_fetch_inc_nbi = pshmem_long_atomic_fetch_inc_nbi
+#define shmem_long_atomic_fetch_inc_nbi pshmem_long_atomic_fetch_inc_nbi
+#pragma weak shmem_longlong_atomic_fetch_inc_nbi = pshmem_longlong_atomic_fetch_inc_nbi
+#define shmem_longlong_atomic_fetch_inc_nbi pshmem_longlong_atomic_fetch_inc_nbi
+#pragma weak shmem_uint_atomic_fetch_inc_nbi = pshmem_uint_atomic_fetch_inc_nbi
+#define shmem_uint_atomic_fetch_inc_nbi pshmem_uint_atomic_fetch_inc_nbi
+#pragma weak shmem_ulong_atomic_fetch_inc_nbi = pshmem_ulong_atomic_fetch_inc_nbi
+#define shmem_ulong_atomic_fetch_inc_nbi pshmem_ulong_atomic_fetch_inc_nbi
+#pragma weak shmem_ulonglong_atomic_fetch_inc_nbi = pshmem_ulonglong_atomic_fetch_inc_nbi
+#define shmem_ulonglong_atomic_fetch_inc_nbi pshmem_ulonglong_atomic_fetch_inc_nbi
+#pragma weak shmem_int32_atomic_fetch_inc_nbi = pshmem_int32_atomic_fetch_inc_nbi
+#define shmem_int32_atomic_fetch_inc_nbi pshmem_int32_atomic_fetch_inc_nbi
+#pragma weak shmem_int64_atomic_fetch_inc_nbi = pshmem_int64_atomic_fetch_inc_nbi
+#define shmem_int64_atomic_fetch_inc_nbi pshmem_int64_atomic_fetch_inc_nbi
+#pragma weak shmem_uint32_atomic_fetch_inc_nbi = pshmem_uint32_atomic_fetch_inc_nbi
+#define shmem_uint32_atomic_fetch_inc_nbi pshmem_uint32_atomic_fetch_inc_nbi
+#pragma weak shmem_uint64_atomic_fetch_inc_nbi = pshmem_uint64_atomic_fetch_inc_nbi
+#define shmem_uint64_atomic_fetch_inc_nbi pshmem_uint64_atomic_fetch_inc_nbi
+#pragma weak shmem_size_atomic_fetch_inc_nbi = pshmem_size_atomic_fetch_inc_nbi
+#define shmem_size_atomic_fetch_inc_nbi pshmem_size_atomic_fetch_inc_nbi
+#pragma weak shmem_ptrdiff_atomic_fetch_inc_nbi = pshmem_ptrdiff_atomic_fetch_inc_nbi
+#define shmem_ptrdiff_atomic_fetch_inc_nbi pshmem_ptrdiff_atomic_fetch_inc_nbi
+#endif /* ENABLE_PSHMEM */
+
+API_DEF_AMO1_NBI(fetch_inc, int, int)
+API_DEF_AMO1_NBI(fetch_inc, long, long)
+API_DEF_AMO1_NBI(fetch_inc, longlong, long long)
+API_DEF_AMO1_NBI(fetch_inc, uint, unsigned int)
+API_DEF_AMO1_NBI(fetch_inc, ulong, unsigned long)
+API_DEF_AMO1_NBI(fetch_inc, ulonglong, unsigned long long)
+API_DEF_AMO1_NBI(fetch_inc, int32, int32_t)
+API_DEF_AMO1_NBI(fetch_inc, int64, int64_t)
+API_DEF_AMO1_NBI(fetch_inc, uint32, uint32_t)
+API_DEF_AMO1_NBI(fetch_inc, uint64, uint64_t)
+API_DEF_AMO1_NBI(fetch_inc, size, size_t)
+API_DEF_AMO1_NBI(fetch_inc, ptrdiff, ptrdiff_t)
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_int_atomic_fetch_add_nbi = pshmem_int_atomic_fetch_add_nbi
+#define shmem_int_atomic_fetch_add_nbi pshmem_int_atomic_fetch_add_nbi
+#pragma weak shmem_long_atomic_fetch_add_nbi = pshmem_long_atomic_fetch_add_nbi
+#define shmem_long_atomic_fetch_add_nbi pshmem_long_atomic_fetch_add_nbi
+#pragma weak shmem_longlong_atomic_fetch_add_nbi = pshmem_longlong_atomic_fetch_add_nbi
+#define shmem_longlong_atomic_fetch_add_nbi pshmem_longlong_atomic_fetch_add_nbi
+#pragma weak shmem_uint_atomic_fetch_add_nbi = pshmem_uint_atomic_fetch_add_nbi
+#define shmem_uint_atomic_fetch_add_nbi pshmem_uint_atomic_fetch_add_nbi
+#pragma weak shmem_ulong_atomic_fetch_add_nbi = pshmem_ulong_atomic_fetch_add_nbi
+#define shmem_ulong_atomic_fetch_add_nbi pshmem_ulong_atomic_fetch_add_nbi
+#pragma weak shmem_ulonglong_atomic_fetch_add_nbi = pshmem_ulonglong_atomic_fetch_add_nbi
+#define shmem_ulonglong_atomic_fetch_add_nbi pshmem_ulonglong_atomic_fetch_add_nbi
+#pragma weak shmem_int32_atomic_fetch_add_nbi = pshmem_int32_atomic_fetch_add_nbi
+#define shmem_int32_atomic_fetch_add_nbi pshmem_int32_atomic_fetch_add_nbi
+#pragma weak shmem_int64_atomic_fetch_add_nbi = pshmem_int64_atomic_fetch_add_nbi
+#define shmem_int64_atomic_fetch_add_nbi pshmem_int64_atomic_fetch_add_nbi
+#pragma weak shmem_uint32_atomic_fetch_add_nbi = pshmem_uint32_atomic_fetch_add_nbi
+#define shmem_uint32_atomic_fetch_add_nbi pshmem_uint32_atomic_fetch_add_nbi
+#pragma weak shmem_uint64_atomic_fetch_add_nbi = pshmem_uint64_atomic_fetch_add_nbi
+#define shmem_uint64_atomic_fetch_add_nbi pshmem_uint64_atomic_fetch_add_nbi
+#pragma weak shmem_size_atomic_fetch_add_nbi = pshmem_size_atomic_fetch_add_nbi
+#define shmem_size_atomic_fetch_add_nbi pshmem_size_atomic_fetch_add_nbi
+#pragma weak shmem_ptrdiff_atomic_fetch_add_nbi = pshmem_ptrdiff_atomic_fetch_add_nbi
+#define shmem_ptrdiff_atomic_fetch_add_nbi pshmem_ptrdiff_atomic_fetch_add_nbi
+#endif /* ENABLE_PSHMEM */
+
+API_DEF_AMO2_NBI(fetch_add, int, int)
+API_DEF_AMO2_NBI(fetch_add, long, long)
+API_DEF_AMO2_NBI(fetch_add, longlong, long long)
+API_DEF_AMO2_NBI(fetch_add, uint, unsigned int)
+API_DEF_AMO2_NBI(fetch_add, ulong, unsigned long)
+API_DEF_AMO2_NBI(fetch_add, ulonglong, unsigned long long)
+API_DEF_AMO2_NBI(fetch_add, int32, int32_t)
+API_DEF_AMO2_NBI(fetch_add, int64, int64_t)
+API_DEF_AMO2_NBI(fetch_add, uint32, uint32_t)
+API_DEF_AMO2_NBI(fetch_add, uint64, uint64_t)
+API_DEF_AMO2_NBI(fetch_add, size, size_t)
+API_DEF_AMO2_NBI(fetch_add, ptrdiff, ptrdiff_t)
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_float_atomic_swap_nbi = pshmem_float_atomic_swap_nbi
+#define shmem_float_atomic_swap_nbi pshmem_float_atomic_swap_nbi
+#pragma weak shmem_double_atomic_swap_nbi = pshmem_double_atomic_swap_nbi
+#define shmem_double_atomic_swap_nbi pshmem_double_atomic_swap_nbi
+#pragma weak shmem_int_atomic_swap_nbi = pshmem_int_atomic_swap_nbi
+#define shmem_int_atomic_swap_nbi pshmem_int_atomic_swap_nbi
+#pragma weak shmem_long_atomic_swap_nbi = pshmem_long_atomic_swap_nbi
+#define shmem_long_atomic_swap_nbi pshmem_long_atomic_swap_nbi
+#pragma weak shmem_longlong_atomic_swap_nbi = pshmem_longlong_atomic_swap_nbi
+#define shmem_longlong_atomic_swap_nbi pshmem_longlong_atomic_swap_nbi
+#pragma weak shmem_uint_atomic_swap_nbi = pshmem_uint_atomic_swap_nbi
+#define shmem_uint_atomic_swap_nbi pshmem_uint_atomic_swap_nbi
+#pragma weak shmem_ulong_atomic_swap_nbi = pshmem_ulong_atomic_swap_nbi
+#define shmem_ulong_atomic_swap_nbi pshmem_ulong_atomic_swap_nbi
+#pragma weak shmem_ulonglong_atomic_swap_nbi = pshmem_ulonglong_atomic_swap_nbi
+#define shmem_ulonglong_atomic_swap_nbi pshmem_ulonglong_atomic_swap_nbi
+#pragma weak shmem_int32_atomic_swap_nbi = pshmem_int32_atomic_swap_nbi
+#define shmem_int32_atomic_swap_nbi pshmem_int32_atomic_swap_nbi
+#pragma weak shmem_int64_atomic_swap_nbi = pshmem_int64_atomic_swap_nbi
+#define shmem_int64_atomic_swap_nbi pshmem_int64_atomic_swap_nbi
+#pragma weak shmem_uint32_atomic_swap_nbi = pshmem_uint32_atomic_swap_nbi
+#define shmem_uint32_atomic_swap_nbi pshmem_uint32_atomic_swap_nbi
+#pragma weak shmem_uint64_atomic_swap_nbi = pshmem_uint64_atomic_swap_nbi
+#define shmem_uint64_atomic_swap_nbi pshmem_uint64_atomic_swap_nbi
+#pragma weak shmem_size_atomic_swap_nbi = pshmem_size_atomic_swap_nbi
+#define shmem_size_atomic_swap_nbi pshmem_size_atomic_swap_nbi
+#pragma weak shmem_ptrdiff_atomic_swap_nbi = pshmem_ptrdiff_atomic_swap_nbi
+#define shmem_ptrdiff_atomic_swap_nbi pshmem_ptrdiff_atomic_swap_nbi
+#endif /* ENABLE_PSHMEM */
+
+API_DEF_AMO2_NBI(swap, float, float)
+API_DEF_AMO2_NBI(swap, double, double)
+API_DEF_AMO2_NBI(swap, int, int)
+API_DEF_AMO2_NBI(swap, long, long)
+API_DEF_AMO2_NBI(swap, longlong, long long)
+API_DEF_AMO2_NBI(swap, uint, unsigned int)
+API_DEF_AMO2_NBI(swap, ulong, unsigned long)
+API_DEF_AMO2_NBI(swap, ulonglong, unsigned long long)
+API_DEF_AMO2_NBI(swap, int32, int32_t)
+API_DEF_AMO2_NBI(swap, int64, int64_t)
+API_DEF_AMO2_NBI(swap, uint32, uint32_t)
+API_DEF_AMO2_NBI(swap, uint64, uint64_t)
+API_DEF_AMO2_NBI(swap, size, size_t)
+API_DEF_AMO2_NBI(swap, ptrdiff, ptrdiff_t)
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_int_atomic_compare_swap_nbi = pshmem_int_atomic_compare_swap_nbi
+#define shmem_int_atomic_compare_swap_nbi pshmem_int_atomic_compare_swap_nbi
+#pragma weak shmem_long_atomic_compare_swap_nbi = pshmem_long_atomic_compare_swap_nbi
+#define shmem_long_atomic_compare_swap_nbi pshmem_long_atomic_compare_swap_nbi
+#pragma weak shmem_longlong_atomic_compare_swap_nbi = pshmem_longlong_atomic_compare_swap_nbi
+#define shmem_longlong_atomic_compare_swap_nbi pshmem_longlong_atomic_compare_swap_nbi
+#pragma weak shmem_uint_atomic_compare_swap_nbi = pshmem_uint_atomic_compare_swap_nbi
+#define shmem_uint_atomic_compare_swap_nbi pshmem_uint_atomic_compare_swap_nbi
+#pragma weak shmem_ulong_atomic_compare_swap_nbi = pshmem_ulong_atomic_compare_swap_nbi
+#define shmem_ulong_atomic_compare_swap_nbi pshmem_ulong_atomic_compare_swap_nbi
+#pragma weak shmem_ulonglong_atomic_compare_swap_nbi = pshmem_ulonglong_atomic_compare_swap_nbi
+#define shmem_ulonglong_atomic_compare_swap_nbi pshmem_ulonglong_atomic_compare_swap_nbi
+#pragma weak shmem_int32_atomic_compare_swap_nbi = pshmem_int32_atomic_compare_swap_nbi
+#define shmem_int32_atomic_compare_swap_nbi pshmem_int32_atomic_compare_swap_nbi
+#pragma weak shmem_int64_atomic_compare_swap_nbi = pshmem_int64_atomic_compare_swap_nbi
+#define shmem_int64_atomic_compare_swap_nbi pshmem_int64_atomic_compare_swap_nbi
+#pragma weak shmem_uint32_atomic_compare_swap_nbi = pshmem_uint32_atomic_compare_swap_nbi
+#define shmem_uint32_atomic_compare_swap_nbi pshmem_uint32_atomic_compare_swap_nbi
+#pragma weak shmem_uint64_atomic_compare_swap_nbi = pshmem_uint64_atomic_compare_swap_nbi
+#define shmem_uint64_atomic_compare_swap_nbi pshmem_uint64_atomic_compare_swap_nbi
+#pragma weak shmem_size_atomic_compare_swap_nbi = pshmem_size_atomic_compare_swap_nbi
+#define shmem_size_atomic_compare_swap_nbi pshmem_size_atomic_compare_swap_nbi
+#pragma weak shmem_ptrdiff_atomic_compare_swap_nbi = pshmem_ptrdiff_atomic_compare_swap_nbi
+#define shmem_ptrdiff_atomic_compare_swap_nbi pshmem_ptrdiff_atomic_compare_swap_nbi
+#endif /* ENABLE_PSHMEM */
+
+API_DEF_AMO3_NBI(compare_swap, int, int)
+API_DEF_AMO3_NBI(compare_swap, long, long)
+API_DEF_AMO3_NBI(compare_swap, longlong, long long)
+API_DEF_AMO3_NBI(compare_swap, uint, unsigned int)
+API_DEF_AMO3_NBI(compare_swap, ulong, unsigned long)
+API_DEF_AMO3_NBI(compare_swap, ulonglong, unsigned long long)
+API_DEF_AMO3_NBI(compare_swap, int32, int32_t)
+API_DEF_AMO3_NBI(compare_swap, int64, int64_t)
+API_DEF_AMO3_NBI(compare_swap, uint32, uint32_t)
+API_DEF_AMO3_NBI(compare_swap, uint64, uint64_t)
+API_DEF_AMO3_NBI(compare_swap, size, size_t)
+API_DEF_AMO3_NBI(compare_swap, ptrdiff, ptrdiff_t)
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmem_uint_atomic_fetch_xor_nbi = pshmem_uint_atomic_fetch_xor_nbi
+#define shmem_uint_atomic_fetch_xor_nbi pshmem_uint_atomic_fetch_xor_nbi
+#pragma weak shmem_ulong_atomic_fetch_xor_nbi = pshmem_ulong_atomic_fetch_xor_nbi
+#define shmem_ulong_atomic_fetch_xor_nbi pshmem_ulong_atomic_fetch_xor_nbi
+#pragma weak shmem_ulonglong_atomic_fetch_xor_nbi = pshmem_ulonglong_atomic_fetch_xor_nbi
+#define shmem_ulonglong_atomic_fetch_xor_nbi pshmem_ulonglong_atomic_fetch_xor_nbi
+#pragma weak shmem_int32_atomic_fetch_xor_nbi = pshmem_int32_atomic_fetch_xor_nbi
+#define shmem_int32_atomic_fetch_xor_nbi pshmem_int32_atomic_fetch_xor_nbi
+#pragma weak shmem_int64_atomic_fetch_xor_nbi = pshmem_int64_atomic_fetch_xor_nbi
+#define shmem_int64_atomic_fetch_xor_nbi pshmem_int64_atomic_fetch_xor_nbi
+#pragma weak shmem_uint32_atomic_fetch_xor_nbi = pshmem_uint32_atomic_fetch_xor_nbi
+#define shmem_uint32_atomic_fetch_xor_nbi pshmem_uint32_atomic_fetch_xor_nbi
+#pragma weak shmem_uint64_atomic_fetch_xor_nbi = pshmem_uint64_atomic_fetch_xor_nbi
+#define shmem_uint64_atomic_fetch_xor_nbi pshmem_uint64_atomic_fetch_xor_nbi
+#pragma weak shmem_uint_atomic_fetch_or_nbi = pshmem_uint_atomic_fetch_or_nbi
+#define shmem_uint_atomic_fetch_or_nbi pshmem_uint_atomic_fetch_or_nbi
+#pragma weak shmem_ulong_atomic_fetch_or_nbi = pshmem_ulong_atomic_fetch_or_nbi
+#define shmem_ulong_atomic_fetch_or_nbi pshmem_ulong_atomic_fetch_or_nbi
+#pragma weak shmem_ulonglong_atomic_fetch_or_nbi = pshmem_ulonglong_atomic_fetch_or_nbi
+#define shmem_ulonglong_atomic_fetch_or_nbi pshmem_ulonglong_atomic_fetch_or_nbi
+#pragma weak shmem_int32_atomic_fetch_or_nbi = pshmem_int32_atomic_fetch_or_nbi
+#define shmem_int32_atomic_fetch_or_nbi pshmem_int32_atomic_fetch_or_nbi
+#pragma weak shmem_int64_atomic_fetch_or_nbi = pshmem_int64_atomic_fetch_or_nbi
+#define shmem_int64_atomic_fetch_or_nbi pshmem_int64_atomic_fetch_or_nbi
+#pragma weak shmem_uint32_atomic_fetch_or_nbi = pshmem_uint32_atomic_fetch_or_nbi
+#define shmem_uint32_atomic_fetch_or_nbi pshmem_uint32_atomic_fetch_or_nbi
+#pragma weak shmem_uint64_atomic_fetch_or_nbi = pshmem_uint64_atomic_fetch_or_nbi
+#define shmem_uint64_atomic_fetch_or_nbi pshmem_uint64_atomic_fetch_or_nbi
+#pragma weak shmem_uint_atomic_fetch_and_nbi = pshmem_uint_atomic_fetch_and_nbi
+#define shmem_uint_atomic_fetch_and_nbi pshmem_uint_atomic_fetch_and_nbi
+#pragma weak shmem_ulong_atomic_fetch_and_nbi = pshmem_ulong_atomic_fetch_and_nbi
+#define shmem_ulong_atomic_fetch_and_nbi pshmem_ulong_atomic_fetch_and_nbi
+#pragma weak shmem_ulonglong_atomic_fetch_and_nbi = pshmem_ulonglong_atomic_fetch_and_nbi
+#define shmem_ulonglong_atomic_fetch_and_nbi pshmem_ulonglong_atomic_fetch_and_nbi
+#pragma weak shmem_int32_atomic_fetch_and_nbi = pshmem_int32_atomic_fetch_and_nbi
+#define shmem_int32_atomic_fetch_and_nbi pshmem_int32_atomic_fetch_and_nbi
+#pragma weak shmem_int64_atomic_fetch_and_nbi = pshmem_int64_atomic_fetch_and_nbi
+#define shmem_int64_atomic_fetch_and_nbi pshmem_int64_atomic_fetch_and_nbi
+#pragma weak shmem_uint32_atomic_fetch_and_nbi = pshmem_uint32_atomic_fetch_and_nbi
+#define shmem_uint32_atomic_fetch_and_nbi pshmem_uint32_atomic_fetch_and_nbi
+#pragma weak shmem_uint64_atomic_fetch_and_nbi = pshmem_uint64_atomic_fetch_and_nbi
+#define shmem_uint64_atomic_fetch_and_nbi pshmem_uint64_atomic_fetch_and_nbi
+#endif /* ENABLE_PSHMEM */
+
+API_DEF_AMO2_NBI(fetch_xor, uint, unsigned int)
+API_DEF_AMO2_NBI(fetch_xor, ulong, unsigned long)
+API_DEF_AMO2_NBI(fetch_xor, ulonglong, unsigned long long)
+API_DEF_AMO2_NBI(fetch_xor, int32, int32_t)
+API_DEF_AMO2_NBI(fetch_xor, int64, int64_t)
+API_DEF_AMO2_NBI(fetch_xor, uint32, uint32_t)
+API_DEF_AMO2_NBI(fetch_xor, uint64, uint64_t)
+
+API_DEF_AMO2_NBI(fetch_or, uint, unsigned int)
+API_DEF_AMO2_NBI(fetch_or, ulong, unsigned long)
+API_DEF_AMO2_NBI(fetch_or, ulonglong, unsigned long long)
+API_DEF_AMO2_NBI(fetch_or, int32, int32_t)
+API_DEF_AMO2_NBI(fetch_or, int64, int64_t)
+API_DEF_AMO2_NBI(fetch_or, uint32, uint32_t)
+API_DEF_AMO2_NBI(fetch_or, uint64, uint64_t)
+
+API_DEF_AMO2_NBI(fetch_and, uint, unsigned int)
+API_DEF_AMO2_NBI(fetch_and, ulong, unsigned long)
+API_DEF_AMO2_NBI(fetch_and, ulonglong, unsigned long long)
+API_DEF_AMO2_NBI(fetch_and, int32, int32_t)
+API_DEF_AMO2_NBI(fetch_and, int64, int64_t)
+API_DEF_AMO2_NBI(fetch_and, uint32, uint32_t)
+API_DEF_AMO2_NBI(fetch_and, uint64, uint64_t)
+
+#undef API_DEF_AMO1_NBI
+#undef API_DEF_AMO2_NBI
+#undef API_DEF_AMO3_NBI
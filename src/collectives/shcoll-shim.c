@@ -3,6 +3,8 @@
 #include "thispe.h"
 #include "shmemu.h"
 #include "collectives/table.h"
+#include "shmem_mutex.h"
+#include "allocator/memalloc.h"
 
 #define TRY(_cname)                                             \
     {                                                           \
@@ -167,6 +169,11 @@ void
 shmem_barrier_all(void)
 {
     colls.barrier_all.f(shmemc_barrier_all_psync);
+
+    /* everyone's passed their frees, so the memory can go back */
+    if (shmema_deferred() > 0) {
+        SHMEMT_MUTEX_PROTECT(shmema_reclaim());
+    }
 }
 
 #ifdef ENABLE_PSHMEM
@@ -88,9 +88,10 @@ shmemx_ctx_start_session(shmem_ctx_t ctx)
 void
 shmemx_ctx_end_session(shmem_ctx_t ctx)
 {
-    NO_WARN_UNUSED(ctx);
-
     SHMEMU_CHECK_INIT();
+
+    /* send anything buffered by a coalescing context */
+    SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_coalesce_flush(ctx));
 }
 
 #endif  /* ENABLE_EXPERIMENTAL */
@@ -0,0 +1,310 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "shmem_mutex.h"
+#include "shmem/api.h"
+#include "shmemx.h"
+
+/*
+ * atomics outside the 1.x API: floating-point add, and min/max.  UCX
+ * can't do these natively, so the comms layer has the target PE apply
+ * them.
+ */
+
+#define SHMEMX_CTX_TYPE_FETCH_OP(_op, _amo_op, _name, _type, _kind)     \
+    _type                                                               \
+    shmemx_ctx_##_name##_atomic_fetch_##_op(shmem_ctx_t ctx,            \
+                                            _type *target,              \
+                                            _type value, int pe)        \
+    {                                                                   \
+        _type v;                                                        \
+                                                                        \
+        SHMEMU_CHECK_INIT();                                            \
+        SHMEMU_CHECK_SYMMETRIC(target, 2);                              \
+                                                                        \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_fetch_op(ctx,                 \
+                                                   _amo_op, _kind,      \
+                                                   target,              \
+                                                   &value,              \
+                                                   sizeof(value),       \
+                                                   pe, &v));            \
+        return v;                                                       \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shmemx_ctx_##_name##_atomic_##_op(shmem_ctx_t ctx,                  \
+                                      _type *target,                    \
+                                      _type value, int pe)              \
+    {                                                                   \
+        (void) shmemx_ctx_##_name##_atomic_fetch_##_op(ctx, target,     \
+                                                       value, pe);      \
+    }                                                                   \
+                                                                        \
+    _type                                                               \
+    shmemx_##_name##_atomic_fetch_##_op(_type *target,                  \
+                                        _type value, int pe)            \
+    {                                                                   \
+        return shmemx_ctx_##_name##_atomic_fetch_##_op(                 \
+                   SHMEM_CTX_DEFAULT, target, value, pe);               \
+    }                                                                   \
+                                                                        \
+    void                                                                \
+    shmemx_##_name##_atomic_##_op(_type *target,                        \
+                                  _type value, int pe)                  \
+    {                                                                   \
+        (void) shmemx_ctx_##_name##_atomic_fetch_##_op(                 \
+                   SHMEM_CTX_DEFAULT, target, value, pe);               \
+    }
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_float_atomic_fetch_add = pshmemx_ctx_float_atomic_fetch_add
+#define shmemx_ctx_float_atomic_fetch_add pshmemx_ctx_float_atomic_fetch_add
+#pragma weak shmemx_ctx_float_atomic_add = pshmemx_ctx_float_atomic_add
+#define shmemx_ctx_float_atomic_add pshmemx_ctx_float_atomic_add
+#pragma weak shmemx_float_atomic_fetch_add = pshmemx_float_atomic_fetch_add
+#define shmemx_float_atomic_fetch_add pshmemx_float_atomic_fetch_add
+#pragma weak shmemx_float_atomic_add = pshmemx_float_atomic_add
+#define shmemx_float_atomic_add pshmemx_float_atomic_add
+#pragma weak shmemx_ctx_double_atomic_fetch_add = pshmemx_ctx_double_atomic_fetch_add
+#define shmemx_ctx_double_atomic_fetch_add pshmemx_ctx_double_atomic_fetch_add
+#pragma weak shmemx_ctx_double_atomic_add = pshmemx_ctx_double_atomic_add
+#define shmemx_ctx_double_atomic_add pshmemx_ctx_double_atomic_add
+#pragma weak shmemx_double_atomic_fetch_add = pshmemx_double_atomic_fetch_add
+#define shmemx_double_atomic_fetch_add pshmemx_double_atomic_fetch_add
+#pragma weak shmemx_double_atomic_add = pshmemx_double_atomic_add
+#define shmemx_double_atomic_add pshmemx_double_atomic_add
+#endif /* ENABLE_PSHMEM */
+
+SHMEMX_CTX_TYPE_FETCH_OP(add, SHMEMC_AMO_ADD, float, float, SHMEMC_AMO_FLOAT)
+SHMEMX_CTX_TYPE_FETCH_OP(add, SHMEMC_AMO_ADD, double, double, SHMEMC_AMO_FLOAT)
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_int_atomic_fetch_min = pshmemx_ctx_int_atomic_fetch_min
+#define shmemx_ctx_int_atomic_fetch_min pshmemx_ctx_int_atomic_fetch_min
+#pragma weak shmemx_ctx_int_atomic_min = pshmemx_ctx_int_atomic_min
+#define shmemx_ctx_int_atomic_min pshmemx_ctx_int_atomic_min
+#pragma weak shmemx_int_atomic_fetch_min = pshmemx_int_atomic_fetch_min
+#define shmemx_int_atomic_fetch_min pshmemx_int_atomic_fetch_min
+#pragma weak shmemx_int_atomic_min = pshmemx_int_atomic_min
+#define shmemx_int_atomic_min pshmemx_int_atomic_min
+#pragma weak shmemx_ctx_long_atomic_fetch_min = pshmemx_ctx_long_atomic_fetch_min
+#define shmemx_ctx_long_atomic_fetch_min pshmemx_ctx_long_atomic_fetch_min
+#pragma weak shmemx_ctx_long_atomic_min = pshmemx_ctx_long_atomic_min
+#define shmemx_ctx_long_atomic_min pshmemx_ctx_long_atomic_min
+#pragma weak shmemx_long_atomic_fetch_min = pshmemx_long_atomic_fetch_min
+#define shmemx_long_atomic_fetch_min pshmemx_long_atomic_fetch_min
+#pragma weak shmemx_long_atomic_min = pshmemx_long_atomic_min
+#define shmemx_long_atomic_min pshmemx_long_atomic_min
+#pragma weak shmemx_ctx_longlong_atomic_fetch_min = pshmemx_ctx_longlong_atomic_fetch_min
+#define shmemx_ctx_longlong_atomic_fetch_min pshmemx_ctx_longlong_atomic_fetch_min
+#pragma weak shmemx_ctx_longlong_atomic_min = pshmemx_ctx_longlong_atomic_min
+#define shmemx_ctx_longlong_atomic_min pshmemx_ctx_longlong_atomic_min
+#pragma weak shmemx_longlong_atomic_fetch_min = pshmemx_longlong_atomic_fetch_min
+#define shmemx_longlong_atomic_fetch_min pshmemx_longlong_atomic_fetch_min
+#pragma weak shmemx_longlong_atomic_min = pshmemx_longlong_atomic_min
+#define shmemx_longlong_atomic_min pshmemx_longlong_atomic_min
+#pragma weak shmemx_ctx_uint_atomic_fetch_min = pshmemx_ctx_uint_atomic_fetch_min
+#define shmemx_ctx_uint_atomic_fetch_min pshmemx_ctx_uint_atomic_fetch_min
+#pragma weak shmemx_ctx_uint_atomic_min = pshmemx_ctx_uint_atomic_min
+#define shmemx_ctx_uint_atomic_min pshmemx_ctx_uint_atomic_min
+#pragma weak shmemx_uint_atomic_fetch_min = pshmemx_uint_atomic_fetch_min
+#define shmemx_uint_atomic_fetch_min pshmemx_uint_atomic_fetch_min
+#pragma weak shmemx_uint_atomic_min = pshmemx_uint_atomic_min
+#define shmemx_uint_atomic_min pshmemx_uint_atomic_min
+#pragma weak shmemx_ctx_ulong_atomic_fetch_min = pshmemx_ctx_ulong_atomic_fetch_min
+#define shmemx_ctx_ulong_atomic_fetch_min pshmemx_ctx_ulong_atomic_fetch_min
+#pragma weak shmemx_ctx_ulong_atomic_min = pshmemx_ctx_ulong_atomic_min
+#define shmemx_ctx_ulong_atomic_min pshmemx_ctx_ulong_atomic_min
+#pragma weak shmemx_ulong_atomic_fetch_min = pshmemx_ulong_atomic_fetch_min
+#define shmemx_ulong_atomic_fetch_min pshmemx_ulong_atomic_fetch_min
+#pragma weak shmemx_ulong_atomic_min = pshmemx_ulong_atomic_min
+#define shmemx_ulong_atomic_min pshmemx_ulong_atomic_min
+#pragma weak shmemx_ctx_ulonglong_atomic_fetch_min = pshmemx_ctx_ulonglong_atomic_fetch_min
+#define shmemx_ctx_ulonglong_atomic_fetch_min pshmemx_ctx_ulonglong_atomic_fetch_min
+#pragma weak shmemx_ctx_ulonglong_atomic_min = pshmemx_ctx_ulonglong_atomic_min
+#define shmemx_ctx_ulonglong_atomic_min pshmemx_ctx_ulonglong_atomic_min
+#pragma weak shmemx_ulonglong_atomic_fetch_min = pshmemx_ulonglong_atomic_fetch_min
+#define shmemx_ulonglong_atomic_fetch_min pshmemx_ulonglong_atomic_fetch_min
+#pragma weak shmemx_ulonglong_atomic_min = pshmemx_ulonglong_atomic_min
+#define shmemx_ulonglong_atomic_min pshmemx_ulonglong_atomic_min
+#pragma weak shmemx_ctx_int32_atomic_fetch_min = pshmemx_ctx_int32_atomic_fetch_min
+#define shmemx_ctx_int32_atomic_fetch_min pshmemx_ctx_int32_atomic_fetch_min
+#pragma weak shmemx_ctx_int32_atomic_min = pshmemx_ctx_int32_atomic_min
+#define shmemx_ctx_int32_atomic_min pshmemx_ctx_int32_atomic_min
+#pragma weak shmemx_int32_atomic_fetch_min = pshmemx_int32_atomic_fetch_min
+#define shmemx_int32_atomic_fetch_min pshmemx_int32_atomic_fetch_min
+#pragma weak shmemx_int32_atomic_min = pshmemx_int32_atomic_min
+#define shmemx_int32_atomic_min pshmemx_int32_atomic_min
+#pragma weak shmemx_ctx_int64_atomic_fetch_min = pshmemx_ctx_int64_atomic_fetch_min
+#define shmemx_ctx_int64_atomic_fetch_min pshmemx_ctx_int64_atomic_fetch_min
+#pragma weak shmemx_ctx_int64_atomic_min = pshmemx_ctx_int64_atomic_min
+#define shmemx_ctx_int64_atomic_min pshmemx_ctx_int64_atomic_min
+#pragma weak shmemx_int64_atomic_fetch_min = pshmemx_int64_atomic_fetch_min
+#define shmemx_int64_atomic_fetch_min pshmemx_int64_atomic_fetch_min
+#pragma weak shmemx_int64_atomic_min = pshmemx_int64_atomic_min
+#define shmemx_int64_atomic_min pshmemx_int64_atomic_min
+#pragma weak shmemx_ctx_uint32_atomic_fetch_min = pshmemx_ctx_uint32_atomic_fetch_min
+#define shmemx_ctx_uint32_atomic_fetch_min pshmemx_ctx_uint32_atomic_fetch_min
+#pragma weak shmemx_ctx_uint32_atomic_min = pshmemx_ctx_uint32_atomic_min
+#define shmemx_ctx_uint32_atomic_min pshmemx_ctx_uint32_atomic_min
+#pragma weak shmemx_uint32_atomic_fetch_min = pshmemx_uint32_atomic_fetch_min
+#define shmemx_uint32_atomic_fetch_min pshmemx_uint32_atomic_fetch_min
+#pragma weak shmemx_uint32_atomic_min = pshmemx_uint32_atomic_min
+#define shmemx_uint32_atomic_min pshmemx_uint32_atomic_min
+#pragma weak shmemx_ctx_uint64_atomic_fetch_min = pshmemx_ctx_uint64_atomic_fetch_min
+#define shmemx_ctx_uint64_atomic_fetch_min pshmemx_ctx_uint64_atomic_fetch_min
+#pragma weak shmemx_ctx_uint64_atomic_min = pshmemx_ctx_uint64_atomic_min
+#define shmemx_ctx_uint64_atomic_min pshmemx_ctx_uint64_atomic_min
+#pragma weak shmemx_uint64_atomic_fetch_min = pshmemx_uint64_atomic_fetch_min
+#define shmemx_uint64_atomic_fetch_min pshmemx_uint64_atomic_fetch_min
+#pragma weak shmemx_uint64_atomic_min = pshmemx_uint64_atomic_min
+#define shmemx_uint64_atomic_min pshmemx_uint64_atomic_min
+#pragma weak shmemx_ctx_float_atomic_fetch_min = pshmemx_ctx_float_atomic_fetch_min
+#define shmemx_ctx_float_atomic_fetch_min pshmemx_ctx_float_atomic_fetch_min
+#pragma weak shmemx_ctx_float_atomic_min = pshmemx_ctx_float_atomic_min
+#define shmemx_ctx_float_atomic_min pshmemx_ctx_float_atomic_min
+#pragma weak shmemx_float_atomic_fetch_min = pshmemx_float_atomic_fetch_min
+#define shmemx_float_atomic_fetch_min pshmemx_float_atomic_fetch_min
+#pragma weak shmemx_float_atomic_min = pshmemx_float_atomic_min
+#define shmemx_float_atomic_min pshmemx_float_atomic_min
+#pragma weak shmemx_ctx_double_atomic_fetch_min = pshmemx_ctx_double_atomic_fetch_min
+#define shmemx_ctx_double_atomic_fetch_min pshmemx_ctx_double_atomic_fetch_min
+#pragma weak shmemx_ctx_double_atomic_min = pshmemx_ctx_double_atomic_min
+#define shmemx_ctx_double_atomic_min pshmemx_ctx_double_atomic_min
+#pragma weak shmemx_double_atomic_fetch_min = pshmemx_double_atomic_fetch_min
+#define shmemx_double_atomic_fetch_min pshmemx_double_atomic_fetch_min
+#pragma weak shmemx_double_atomic_min = pshmemx_double_atomic_min
+#define shmemx_double_atomic_min pshmemx_double_atomic_min
+#endif /* ENABLE_PSHMEM */
+
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, int, int, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, long, long, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, longlong, long long, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, uint, unsigned int, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, ulong, unsigned long, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, ulonglong, unsigned long long, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, int32, int32_t, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, int64, int64_t, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, uint32, uint32_t, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, uint64, uint64_t, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, float, float, SHMEMC_AMO_FLOAT)
+SHMEMX_CTX_TYPE_FETCH_OP(min, SHMEMC_AMO_MIN, double, double, SHMEMC_AMO_FLOAT)
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_ctx_int_atomic_fetch_max = pshmemx_ctx_int_atomic_fetch_max
+#define shmemx_ctx_int_atomic_fetch_max pshmemx_ctx_int_atomic_fetch_max
+#pragma weak shmemx_ctx_int_atomic_max = pshmemx_ctx_int_atomic_max
+#define shmemx_ctx_int_atomic_max pshmemx_ctx_int_atomic_max
+#pragma weak shmemx_int_atomic_fetch_max = pshmemx_int_atomic_fetch_max
+#define shmemx_int_atomic_fetch_max pshmemx_int_atomic_fetch_max
+#pragma weak shmemx_int_atomic_max = pshmemx_int_atomic_max
+#define shmemx_int_atomic_max pshmemx_int_atomic_max
+#pragma weak shmemx_ctx_long_atomic_fetch_max = pshmemx_ctx_long_atomic_fetch_max
+#define shmemx_ctx_long_atomic_fetch_max pshmemx_ctx_long_atomic_fetch_max
+#pragma weak shmemx_ctx_long_atomic_max = pshmemx_ctx_long_atomic_max
+#define shmemx_ctx_long_atomic_max pshmemx_ctx_long_atomic_max
+#pragma weak shmemx_long_atomic_fetch_max = pshmemx_long_atomic_fetch_max
+#define shmemx_long_atomic_fetch_max pshmemx_long_atomic_fetch_max
+#pragma weak shmemx_long_atomic_max = pshmemx_long_atomic_max
+#define shmemx_long_atomic_max pshmemx_long_atomic_max
+#pragma weak shmemx_ctx_longlong_atomic_fetch_max = pshmemx_ctx_longlong_atomic_fetch_max
+#define shmemx_ctx_longlong_atomic_fetch_max pshmemx_ctx_longlong_atomic_fetch_max
+#pragma weak shmemx_ctx_longlong_atomic_max = pshmemx_ctx_longlong_atomic_max
+#define shmemx_ctx_longlong_atomic_max pshmemx_ctx_longlong_atomic_max
+#pragma weak shmemx_longlong_atomic_fetch_max = pshmemx_longlong_atomic_fetch_max
+#define shmemx_longlong_atomic_fetch_max pshmemx_longlong_atomic_fetch_max
+#pragma weak shmemx_longlong_atomic_max = pshmemx_longlong_atomic_max
+#define shmemx_longlong_atomic_max pshmemx_longlong_atomic_max
+#pragma weak shmemx_ctx_uint_atomic_fetch_max = pshmemx_ctx_uint_atomic_fetch_max
+#define shmemx_ctx_uint_atomic_fetch_max pshmemx_ctx_uint_atomic_fetch_max
+#pragma weak shmemx_ctx_uint_atomic_max = pshmemx_ctx_uint_atomic_max
+#define shmemx_ctx_uint_atomic_max pshmemx_ctx_uint_atomic_max
+#pragma weak shmemx_uint_atomic_fetch_max = pshmemx_uint_atomic_fetch_max
+#define shmemx_uint_atomic_fetch_max pshmemx_uint_atomic_fetch_max
+#pragma weak shmemx_uint_atomic_max = pshmemx_uint_atomic_max
+#define shmemx_uint_atomic_max pshmemx_uint_atomic_max
+#pragma weak shmemx_ctx_ulong_atomic_fetch_max = pshmemx_ctx_ulong_atomic_fetch_max
+#define shmemx_ctx_ulong_atomic_fetch_max pshmemx_ctx_ulong_atomic_fetch_max
+#pragma weak shmemx_ctx_ulong_atomic_max = pshmemx_ctx_ulong_atomic_max
+#define shmemx_ctx_ulong_atomic_max pshmemx_ctx_ulong_atomic_max
+#pragma weak shmemx_ulong_atomic_fetch_max = pshmemx_ulong_atomic_fetch_max
+#define shmemx_ulong_atomic_fetch_max pshmemx_ulong_atomic_fetch_max
+#pragma weak shmemx_ulong_atomic_max = pshmemx_ulong_atomic_max
+#define shmemx_ulong_atomic_max pshmemx_ulong_atomic_max
+#pragma weak shmemx_ctx_ulonglong_atomic_fetch_max = pshmemx_ctx_ulonglong_atomic_fetch_max
+#define shmemx_ctx_ulonglong_atomic_fetch_max pshmemx_ctx_ulonglong_atomic_fetch_max
+#pragma weak shmemx_ctx_ulonglong_atomic_max = pshmemx_ctx_ulonglong_atomic_max
+#define shmemx_ctx_ulonglong_atomic_max pshmemx_ctx_ulonglong_atomic_max
+#pragma weak shmemx_ulonglong_atomic_fetch_max = pshmemx_ulonglong_atomic_fetch_max
+#define shmemx_ulonglong_atomic_fetch_max pshmemx_ulonglong_atomic_fetch_max
+#pragma weak shmemx_ulonglong_atomic_max = pshmemx_ulonglong_atomic_max
+#define shmemx_ulonglong_atomic_max pshmemx_ulonglong_atomic_max
+#pragma weak shmemx_ctx_int32_atomic_fetch_max = pshmemx_ctx_int32_atomic_fetch_max
+#define shmemx_ctx_int32_atomic_fetch_max pshmemx_ctx_int32_atomic_fetch_max
+#pragma weak shmemx_ctx_int32_atomic_max = pshmemx_ctx_int32_atomic_max
+#define shmemx_ctx_int32_atomic_max pshmemx_ctx_int32_atomic_max
+#pragma weak shmemx_int32_atomic_fetch_max = pshmemx_int32_atomic_fetch_max
+#define shmemx_int32_atomic_fetch_max pshmemx_int32_atomic_fetch_max
+#pragma weak shmemx_int32_atomic_max = pshmemx_int32_atomic_max
+#define shmemx_int32_atomic_max pshmemx_int32_atomic_max
+#pragma weak shmemx_ctx_int64_atomic_fetch_max = pshmemx_ctx_int64_atomic_fetch_max
+#define shmemx_ctx_int64_atomic_fetch_max pshmemx_ctx_int64_atomic_fetch_max
+#pragma weak shmemx_ctx_int64_atomic_max = pshmemx_ctx_int64_atomic_max
+#define shmemx_ctx_int64_atomic_max pshmemx_ctx_int64_atomic_max
+#pragma weak shmemx_int64_atomic_fetch_max = pshmemx_int64_atomic_fetch_max
+#define shmemx_int64_atomic_fetch_max pshmemx_int64_atomic_fetch_max
+#pragma weak shmemx_int64_atomic_max = pshmemx_int64_atomic_max
+#define shmemx_int64_atomic_max pshmemx_int64_atomic_max
+#pragma weak shmemx_ctx_uint32_atomic_fetch_max = pshmemx_ctx_uint32_atomic_fetch_max
+#define shmemx_ctx_uint32_atomic_fetch_max pshmemx_ctx_uint32_atomic_fetch_max
+#pragma weak shmemx_ctx_uint32_atomic_max = pshmemx_ctx_uint32_atomic_max
+#define shmemx_ctx_uint32_atomic_max pshmemx_ctx_uint32_atomic_max
+#pragma weak shmemx_uint32_atomic_fetch_max = pshmemx_uint32_atomic_fetch_max
+#define shmemx_uint32_atomic_fetch_max pshmemx_uint32_atomic_fetch_max
+#pragma weak shmemx_uint32_atomic_max = pshmemx_uint32_atomic_max
+#define shmemx_uint32_atomic_max pshmemx_uint32_atomic_max
+#pragma weak shmemx_ctx_uint64_atomic_fetch_max = pshmemx_ctx_uint64_atomic_fetch_max
+#define shmemx_ctx_uint64_atomic_fetch_max pshmemx_ctx_uint64_atomic_fetch_max
+#pragma weak shmemx_ctx_uint64_atomic_max = pshmemx_ctx_uint64_atomic_max
+#define shmemx_ctx_uint64_atomic_max pshmemx_ctx_uint64_atomic_max
+#pragma weak shmemx_uint64_atomic_fetch_max = pshmemx_uint64_atomic_fetch_max
+#define shmemx_uint64_atomic_fetch_max pshmemx_uint64_atomic_fetch_max
+#pragma weak shmemx_uint64_atomic_max = pshmemx_uint64_atomic_max
+#define shmemx_uint64_atomic_max pshmemx_uint64_atomic_max
+#pragma weak shmemx_ctx_float_atomic_fetch_max = pshmemx_ctx_float_atomic_fetch_max
+#define shmemx_ctx_float_atomic_fetch_max pshmemx_ctx_float_atomic_fetch_max
+#pragma weak shmemx_ctx_float_atomic_max = pshmemx_ctx_float_atomic_max
+#define shmemx_ctx_float_atomic_max pshmemx_ctx_float_atomic_max
+#pragma weak shmemx_float_atomic_fetch_max = pshmemx_float_atomic_fetch_max
+#define shmemx_float_atomic_fetch_max pshmemx_float_atomic_fetch_max
+#pragma weak shmemx_float_atomic_max = pshmemx_float_atomic_max
+#define shmemx_float_atomic_max pshmemx_float_atomic_max
+#pragma weak shmemx_ctx_double_atomic_fetch_max = pshmemx_ctx_double_atomic_fetch_max
+#define shmemx_ctx_double_atomic_fetch_max pshmemx_ctx_double_atomic_fetch_max
+#pragma weak shmemx_ctx_double_atomic_max = pshmemx_ctx_double_atomic_max
+#define shmemx_ctx_double_atomic_max pshmemx_ctx_double_atomic_max
+#pragma weak shmemx_double_atomic_fetch_max = pshmemx_double_atomic_fetch_max
+#define shmemx_double_atomic_fetch_max pshmemx_double_atomic_fetch_max
+#pragma weak shmemx_double_atomic_max = pshmemx_double_atomic_max
+#define shmemx_double_atomic_max pshmemx_double_atomic_max
+#endif /* ENABLE_PSHMEM */
+
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, int, int, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, long, long, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, longlong, long long, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, uint, unsigned int, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, ulong, unsigned long, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, ulonglong, unsigned long long, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, int32, int32_t, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, int64, int64_t, SHMEMC_AMO_SIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, uint32, uint32_t, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, uint64, uint64_t, SHMEMC_AMO_UNSIGNED)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, float, float, SHMEMC_AMO_FLOAT)
+SHMEMX_CTX_TYPE_FETCH_OP(max, SHMEMC_AMO_MAX, double, double, SHMEMC_AMO_FLOAT)
+
+#undef SHMEMX_CTX_TYPE_FETCH_OP
@@ -7,13 +7,18 @@
 #include "shmemu.h"
 #include "shmemc.h"
 #include "shmem/api.h"
+#include "shmemx.h"
 
 #include "shmem_mutex.h"
+#include "allocator/memalloc.h"
 #include "allocator/xmemalloc.h"
+#include "heapgrow.h"
+#include "heapstats.h"
 
 #include <stdio.h>
 #include <sys/types.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*
  * -- API --------------------------------------------------------------------
@@ -63,6 +68,12 @@ shmemx_malloc_by_index(shmemx_heap_index_t index, size_t s)
     SHMEMU_CHECK_INIT();
     SHMEMU_CHECK_HEAP_INDEX(index);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_malloc(s);
+        /* NOT REACHED */
+    }
+
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_malloc_by_index(index, s));
 
     shmem_barrier_all();
@@ -78,6 +89,12 @@ shmemx_calloc_by_index(shmemx_heap_index_t index, size_t n, size_t s)
     SHMEMU_CHECK_INIT();
     SHMEMU_CHECK_HEAP_INDEX(index);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_calloc(n, s);
+        /* NOT REACHED */
+    }
+
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_calloc_by_index(index, n, s));
 
     shmem_barrier_all();
@@ -92,6 +109,13 @@ shmemx_free_by_index(shmemx_heap_index_t index, void *p)
     SHMEMU_CHECK_HEAP_INDEX(index);
     SHMEMU_CHECK_SYMMETRIC(p, 2);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        shmem_free(p);
+        return;
+        /* NOT REACHED */
+    }
+
     shmem_barrier_all();
 
     SHMEMT_MUTEX_PROTECT(shmemxa_free_by_index(index, p));
@@ -111,6 +135,12 @@ shmemx_realloc_by_index(shmemx_heap_index_t index, void *p, size_t s)
     SHMEMU_CHECK_HEAP_INDEX(index);
     SHMEMU_CHECK_SYMMETRIC(p, 2);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_realloc(p, s);
+        /* NOT REACHED */
+    }
+
     shmem_barrier_all();
 
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_realloc_by_index(index, p, s));
@@ -128,6 +158,12 @@ shmemx_align_by_index(shmemx_heap_index_t index, size_t a, size_t s)
     SHMEMU_CHECK_INIT();
     SHMEMU_CHECK_HEAP_INDEX(index);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_align(a, s);
+        /* NOT REACHED */
+    }
+
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_align_by_index(index, a, s));
 
     shmem_barrier_all();
@@ -135,6 +171,41 @@ shmemx_align_by_index(shmemx_heap_index_t index, size_t a, size_t s)
     return addr;
 }
 
+/*
+ * heap usage, local.  Returns 0 on success, -1 if no such heap.
+ */
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_heap_stats = pshmemx_heap_stats
+#define shmemx_heap_stats pshmemx_heap_stats
+#endif /* ENABLE_PSHMEM */
+
+int
+shmemx_heap_stats(shmemx_heap_index_t index, shmemx_heap_stats_t *stats)
+{
+    shmema_usage_t u;
+
+    SHMEMU_CHECK_INIT();
+
+    if ((index < 0) || ((size_t) index >= heapstats_nheaps())) {
+        return -1;
+        /* NOT REACHED */
+    }
+
+    SHMEMT_MUTEX_PROTECT(heapstats_get((size_t) index, &u));
+
+    stats->capacity = u.capacity;
+    stats->used = u.used;
+    stats->free = u.free;
+    stats->largest_free = u.largest_free;
+    stats->blocks = u.blocks;
+    stats->allocs = u.allocs;
+    stats->peak = u.peak;
+    stats->fragmentation = heapstats_fragmentation(&u);
+
+    return 0;
+}
+
 /*
  * use string as name to access
  */
@@ -159,8 +230,21 @@ shmemx_malloc_by_name(const char *name, size_t s)
     void *addr;
 
     SHMEMU_CHECK_INIT();
+
+    /* not a heap named in SHMEM_HEAPS */
+    if (index < 0) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
     SHMEMU_CHECK_HEAP_INDEX(index);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_malloc(s);
+        /* NOT REACHED */
+    }
+
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_malloc_by_index(index, s));
 
     return addr;
@@ -173,8 +257,21 @@ shmemx_calloc_by_name(const char *name, size_t n, size_t s)
     void *addr;
 
     SHMEMU_CHECK_INIT();
+
+    /* not a heap named in SHMEM_HEAPS */
+    if (index < 0) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
     SHMEMU_CHECK_HEAP_INDEX(index);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_calloc(n, s);
+        /* NOT REACHED */
+    }
+
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_calloc_by_index(index, n, s));
 
     return addr;
@@ -186,9 +283,23 @@ shmemx_free_by_name(const char *name, void *p)
     const shmemx_heap_index_t index = shmemxa_name_to_index(name);
 
     SHMEMU_CHECK_INIT();
+
+    /* not a heap named in SHMEM_HEAPS */
+    if (index < 0) {
+        return;
+        /* NOT REACHED */
+    }
+
     SHMEMU_CHECK_HEAP_INDEX(index);
     SHMEMU_CHECK_SYMMETRIC(p, 2);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        shmem_free(p);
+        return;
+        /* NOT REACHED */
+    }
+
     shmem_barrier_all();
 
     SHMEMT_MUTEX_PROTECT(shmemxa_free_by_index(index, p));
@@ -201,9 +312,22 @@ shmemx_realloc_by_name(const char *name, void *p, size_t s)
     void *addr;
 
     SHMEMU_CHECK_INIT();
+
+    /* not a heap named in SHMEM_HEAPS */
+    if (index < 0) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
     SHMEMU_CHECK_HEAP_INDEX(index);
     SHMEMU_CHECK_SYMMETRIC(p, 2);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_realloc(p, s);
+        /* NOT REACHED */
+    }
+
     shmem_barrier_all();
 
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_realloc_by_index(index, p, s));
@@ -220,11 +344,295 @@ shmemx_align_by_name(const char *name, size_t a, size_t s)
     void *addr;
 
     SHMEMU_CHECK_INIT();
+
+    /* not a heap named in SHMEM_HEAPS */
+    if (index < 0) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
     SHMEMU_CHECK_HEAP_INDEX(index);
 
+    /* default heap: shmem_* routines know about its growth */
+    if (index == 0) {
+        return shmem_align(a, s);
+        /* NOT REACHED */
+    }
+
     SHMEMT_MUTEX_PROTECT(addr = shmemxa_align_by_index(index, a, s));
 
     shmem_barrier_all();
 
     return addr;
 }
+
+/*
+ * batches from the default heap: one lock and one barrier for the
+ * lot, instead of one of each per block
+ */
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_malloc_batch = pshmemx_malloc_batch
+#define shmemx_malloc_batch pshmemx_malloc_batch
+#pragma weak shmemx_free_batch = pshmemx_free_batch
+#define shmemx_free_batch pshmemx_free_batch
+#pragma weak shmemx_heap_reclaim = pshmemx_heap_reclaim
+#define shmemx_heap_reclaim pshmemx_heap_reclaim
+#endif /* ENABLE_PSHMEM */
+
+/*
+ * all or nothing, so a retry after growing the heap starts from the
+ * same place on every PE
+ */
+static bool
+alloc_batch(size_t n, const size_t sizes[], void *ptrs[])
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        ptrs[i] = (sizes[i] > 0) ? shmema_malloc(sizes[i]) : NULL;
+
+        if ((ptrs[i] == NULL) && (sizes[i] > 0)) {
+            while (i > 0) {
+                i -= 1;
+                shmema_free(ptrs[i]);
+            }
+            memset(ptrs, 0, n * sizeof(*ptrs));
+            return false;
+            /* NOT REACHED */
+        }
+    }
+
+    return true;
+}
+
+inline static void
+free_batch(size_t n, void *ptrs[])
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        shmema_free(ptrs[i]);
+    }
+}
+
+inline static int
+defer_free_batch(size_t n, void *ptrs[])
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        if (shmema_free_deferred(ptrs[i]) != 0) {
+            return -1;
+            /* NOT REACHED */
+        }
+    }
+
+    return 0;
+}
+
+#ifdef ENABLE_DEBUG
+
+/*
+ * Every PE has to ask for the same sizes, or the heaps stop being
+ * symmetric.  PE 0 leaves a hash of its request in a buffer set up at
+ * start-up, and after the batch's own barrier everyone else compares
+ * theirs with it.  Batches alternate between 2 slots: PE 0 can't come
+ * back round to a slot until everyone has passed the next batch's
+ * barrier, so they've all finished reading it.
+ */
+
+extern long *shmemc_batch_check_hash;
+
+static unsigned long nbatches = 0;
+
+static long
+batch_hash(size_t n, const size_t sizes[])
+{
+    uint64_t h = 14695981039346656037ULL; /* FNV-1a */
+    size_t i;
+
+    h = (h ^ n) * 1099511628211ULL;
+    for (i = 0; i < n; ++i) {
+        h = (h ^ sizes[i]) * 1099511628211ULL;
+    }
+
+    return (long) h;
+}
+
+/*
+ * before the batch's barrier
+ */
+static long
+batch_check_begin(size_t n, const size_t sizes[])
+{
+    const long h = batch_hash(n, sizes);
+
+    if (proc.rank == 0) {
+        shmemc_batch_check_hash[nbatches & 1] = h;
+    }
+
+    return h;
+}
+
+/*
+ * after the batch's barrier
+ */
+static void
+batch_check_end(long h)
+{
+    long *slot = & shmemc_batch_check_hash[nbatches & 1];
+
+    ++nbatches;
+
+    if ((proc.rank != 0) && (shmem_long_g(slot, 0) != h)) {
+        shmemu_fatal("shmemx_malloc_batch: PEs asked for different sizes");
+        /* NOT REACHED */
+    }
+}
+
+#else
+
+# define batch_check_begin(_n, _sizes) 0
+# define batch_check_end(_h) NO_WARN_UNUSED(_h)
+
+#endif  /* ENABLE_DEBUG */
+
+int
+shmemx_malloc_batch(size_t n, const size_t sizes[], void *ptrs[])
+{
+    size_t total = 0;
+    size_t need;
+    size_t i;
+    bool ok;
+    long check;
+
+    SHMEMU_CHECK_INIT();
+
+    if (shmemu_unlikely(n == 0)) {
+        return 0;
+        /* NOT REACHED */
+    }
+
+    /* let deferred frees be reused (see shmem_malloc) */
+    if (shmema_deferred() > 0) {
+        shmem_barrier_all();
+    }
+
+    check = batch_check_begin(n, sizes);
+
+    SHMEMT_MUTEX_PROTECT(ok = alloc_batch(n, sizes, ptrs));
+
+    shmem_barrier_all();
+
+    batch_check_end(check);
+
+    /* if it didn't fit somewhere, grow the heap everywhere and retry */
+    for (i = 0; i < n; ++i) {
+        total += sizes[i] + 16; /* allocator overhead */
+    }
+    while ((need = heapgrow_needed(ok ? ptrs : NULL, total)) > 0) {
+        if (ok) {
+            SHMEMT_MUTEX_PROTECT(free_batch(n, ptrs));
+        }
+        if (! heapgrow_extend(need)) {
+            memset(ptrs, 0, n * sizeof(*ptrs));
+            ok = false;
+            break;
+        }
+        SHMEMT_MUTEX_PROTECT(ok = alloc_batch(n, sizes, ptrs));
+    }
+
+    logger(LOG_MEMORY,
+           "%s(n=%lu, total=%lu) -> %s",
+           __func__,
+           (unsigned long) n, (unsigned long) total,
+           ok ? "ok" : "failed"
+           );
+
+    return ok ? 0 : -1;
+}
+
+void
+shmemx_free_batch(size_t n, void *ptrs[])
+{
+    SHMEMU_CHECK_INIT();
+
+    if (shmemu_unlikely(n == 0)) {
+        return;
+        /* NOT REACHED */
+    }
+
+    if (proc.env.deferred_free) {
+        int s;
+
+        SHMEMT_MUTEX_PROTECT(s = defer_free_batch(n, ptrs));
+        if (s != 0) {
+            shmemu_fatal("can't queue deferred free of batch");
+            /* NOT REACHED */
+        }
+
+        logger(LOG_MEMORY, "%s(n=%lu) [deferred]",
+               __func__, (unsigned long) n);
+        return;
+        /* NOT REACHED */
+    }
+
+    shmem_barrier_all();
+
+    SHMEMT_MUTEX_PROTECT(free_batch(n, ptrs));
+
+    logger(LOG_MEMORY, "%s(n=%lu)", __func__, (unsigned long) n);
+}
+
+/*
+ * registered local buffers
+ */
+
+#ifdef ENABLE_PSHMEM
+#pragma weak shmemx_alloc_local_registered = pshmemx_alloc_local_registered
+#define shmemx_alloc_local_registered pshmemx_alloc_local_registered
+#pragma weak shmemx_free_local_registered = pshmemx_free_local_registered
+#define shmemx_free_local_registered pshmemx_free_local_registered
+#endif /* ENABLE_PSHMEM */
+
+void *
+shmemx_alloc_local_registered(size_t size)
+{
+    void *ret;
+
+    SHMEMU_CHECK_INIT();
+
+    ret = shmemc_bounce_alloc(size);
+
+    logger(LOG_MEMORY,
+           "%s(size=%lu) -> %p",
+           __func__,
+           (unsigned long) size, ret
+           );
+
+    return ret;
+}
+
+void
+shmemx_free_local_registered(void *ptr)
+{
+    SHMEMU_CHECK_INIT();
+
+    shmemc_bounce_free(ptr);
+
+    logger(LOG_MEMORY, "%s(ptr=%p)", __func__, ptr);
+}
+
+/*
+ * the barrier hands back anything waiting
+ */
+void
+shmemx_heap_reclaim(void)
+{
+    SHMEMU_CHECK_INIT();
+
+    shmem_barrier_all();
+
+    logger(LOG_MEMORY, "%s()", __func__);
+}
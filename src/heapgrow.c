@@ -0,0 +1,230 @@
+/* For license: see LICENSE file at top-level */
+
+/*
+ * Growing the default symmetric heap when it fills up, if
+ * SHMEM_SYMMETRIC_GROW is set.  All PEs map and register a new region
+ * of the same size, then swap addresses and rkeys with fcollect,
+ * through a mailbox kept in the heap we started with.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "shmemu.h"
+#include "shmemc.h"
+#include "heapgrow.h"
+#include "allocator/memalloc.h"
+#include "shmem/api.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * Records are exchanged a chunk per PE at a time, in as many rounds
+ * as the biggest one needs.  The mailbox is about this big, but each
+ * PE gets at least the minimum chunk.
+ */
+#define MAILBOX_SIZE (64 * 1024)
+#define MIN_CHUNK    64
+
+typedef struct mailbox_record {
+    uint64_t base;
+    uint64_t len;
+    uint64_t rkey_len;
+    /* rkey follows */
+} mailbox_record_t;
+
+typedef struct heapgrow_symm {
+    long psync[2][SHMEM_REDUCE_SYNC_SIZE];
+    long pwrk[SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+    long csync[2][SHMEM_COLLECT_SYNC_SIZE];
+    long vote_in;
+    long vote_out;
+} heapgrow_symm_t;
+
+static heapgrow_symm_t *hgp = NULL; /* NULL if not growing */
+
+/*
+ * 2 mailboxes, used alternately so a round can't overwrite one still
+ * being read: each is a chunk from every PE, then our outgoing chunk
+ */
+static char *mailbox;
+static size_t chunk;
+
+void
+heapgrow_init(void)
+{
+    const int npes = shmem_n_pes();
+    int i;
+
+    if (proc.env.heap_grow == 0) {
+        return;
+        /* NOT REACHED */
+    }
+
+    /* every PE does this at the same point, so it's symmetric */
+    hgp = (heapgrow_symm_t *) shmema_malloc(sizeof(*hgp));
+    shmemu_assert(hgp != NULL,
+                  "can't allocate memory to grow symmetric heap");
+
+    for (i = 0; i < SHMEM_REDUCE_SYNC_SIZE; ++i) {
+        hgp->psync[0][i] = SHMEM_SYNC_VALUE;
+        hgp->psync[1][i] = SHMEM_SYNC_VALUE;
+    }
+    for (i = 0; i < SHMEM_COLLECT_SYNC_SIZE; ++i) {
+        hgp->csync[0][i] = SHMEM_SYNC_VALUE;
+        hgp->csync[1][i] = SHMEM_SYNC_VALUE;
+    }
+
+    chunk = (MAILBOX_SIZE / npes) & ~(sizeof(uint64_t) - 1);
+    if (chunk < MIN_CHUNK) {
+        chunk = MIN_CHUNK;
+    }
+
+    mailbox = (char *) shmema_malloc(2 * (npes + 1) * chunk);
+    shmemu_assert(mailbox != NULL,
+                  "can't allocate memory to grow symmetric heap");
+}
+
+void
+heapgrow_finalize(void)
+{
+    if (hgp != NULL) {
+        shmema_free(mailbox);
+        shmema_free(hgp);
+        hgp = NULL;
+    }
+}
+
+/*
+ * largest VALUE across all PEs.  Alternate sync arrays so back-to-back
+ * votes don't trip over each other.
+ */
+inline static long
+vote_max(long value, int which)
+{
+    hgp->vote_in = value;
+
+    shmem_long_max_to_all(&hgp->vote_out, &hgp->vote_in, 1,
+                          0, 0, shmem_n_pes(),
+                          hgp->pwrk, hgp->psync[which]);
+
+    return hgp->vote_out;
+}
+
+/*
+ * Collective if growing.  Returns the biggest request that failed on
+ * any PE, or 0 if all succeeded (or we can't grow).
+ */
+
+size_t
+heapgrow_needed(const void *addr, size_t bytes)
+{
+    if (hgp == NULL) {
+        return 0;
+        /* NOT REACHED */
+    }
+
+    return (size_t) vote_max((addr == NULL) ? (long) bytes : 0L, 0);
+}
+
+/*
+ * Collective.  Add a region that can take NEED bytes.  Returns
+ * true if it worked, false if the heap can't grow any more.
+ */
+
+bool
+heapgrow_extend(size_t need)
+{
+    const int npes = shmem_n_pes();
+    uint64_t base;
+    size_t len;
+    size_t got;
+    void *rkey;
+    size_t rkey_len;
+    size_t slot;
+    size_t rounds;
+    size_t k;
+    char *rec;
+    char *all;
+    int pe;
+    int s;
+
+    /* leave room for allocator overhead */
+    len = need + (need / 16) + (64 * 1024);
+    if (len < proc.env.heap_grow) {
+        len = proc.env.heap_grow;
+    }
+
+    /* same answer everywhere: extensions are counted on all PEs */
+    if (! shmemc_heap_extend_begin(len, &base, &got, &rkey, &rkey_len)) {
+        return false;
+        /* NOT REACHED */
+    }
+
+    /* everyone's record takes the same number of chunks */
+    slot = sizeof(mailbox_record_t) + (size_t) vote_max((long) rkey_len, 1);
+    rounds = (slot + chunk - 1) / chunk;
+    slot = rounds * chunk;
+
+    rec = (char *) calloc(1, slot);
+    all = (char *) malloc(npes * slot);
+    shmemu_assert((rec != NULL) && (all != NULL),
+                  "can't allocate memory to grow symmetric heap");
+    {
+        mailbox_record_t h;
+
+        h.base     = base;
+        h.len      = got;
+        h.rkey_len = rkey_len;
+
+        memcpy(rec, &h, sizeof(h));
+        memcpy(rec + sizeof(h), rkey, rkey_len);
+    }
+
+    /*
+     * nobody can start round K + 2 (same mailbox) before everyone has
+     * contributed to K + 1, i.e. finished reading K
+     */
+    for (k = 0; k < rounds; ++k) {
+        char *box = mailbox + (k & 1) * (npes + 1) * chunk;
+        char *out = box + npes * chunk;
+
+        memcpy(out, rec + k * chunk, chunk);
+
+        shmem_fcollect64(box, out, chunk / sizeof(uint64_t),
+                         0, 0, npes, hgp->csync[k & 1]);
+
+        for (pe = 0; pe < npes; ++pe) {
+            memcpy(all + pe * slot + k * chunk, box + pe * chunk, chunk);
+        }
+    }
+
+    for (pe = 0; pe < npes; ++pe) {
+        const char *src = all + pe * slot;
+        mailbox_record_t h;
+
+        memcpy(&h, src, sizeof(h));
+
+        shmemc_heap_extend_peer(pe, h.base, h.len,
+                                src + sizeof(h), h.rkey_len);
+    }
+
+    free(all);
+    free(rec);
+
+    shmemc_heap_extend_end();
+
+    /* same capacity everywhere, whatever the mapping got rounded to */
+    s = shmema_extend((void *) base, len);
+    shmemu_assert(s == 0,
+                  "can't add memory to symmetric heap allocator");
+
+    logger(LOG_MEMORY,
+           "grew symmetric heap by %lu bytes for a %lu-byte request",
+           (unsigned long) len, (unsigned long) need);
+
+    return true;
+}
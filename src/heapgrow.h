@@ -0,0 +1,16 @@
+/* For license: see LICENSE file at top-level */
+
+#ifndef _SHMEM_HEAPGROW_H
+#define _SHMEM_HEAPGROW_H 1
+
+#include "boolean.h"
+
+#include <sys/types.h>          /* size_t */
+
+void heapgrow_init(void);
+void heapgrow_finalize(void);
+
+size_t heapgrow_needed(const void *addr, size_t bytes);
+bool heapgrow_extend(size_t need);
+
+#endif  /* ! _SHMEM_HEAPGROW_H */
@@ -0,0 +1,106 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "thispe.h"
+#include "shmemu.h"
+#include "heapstats.h"
+#ifdef ENABLE_EXPERIMENTAL
+# include "allocator/xmemalloc.h"
+#endif  /* ENABLE_EXPERIMENTAL */
+
+#include <stdio.h>
+
+/*
+ * How full are the symmetric heaps, and how badly fragmented?  All
+ * local: heaps are symmetric, so any PE's view is representative.
+ */
+
+#define BUFSIZE 16
+
+/*
+ * the named heaps only exist with the extensions
+ */
+size_t
+heapstats_nheaps(void)
+{
+#ifdef ENABLE_EXPERIMENTAL
+    return proc.env.heaps.nheaps;
+#else
+    return 1;
+#endif  /* ENABLE_EXPERIMENTAL */
+}
+
+/*
+ * heap #0 is the default one, which may have grown
+ */
+void
+heapstats_get(size_t h, shmema_usage_t *up)
+{
+#ifdef ENABLE_EXPERIMENTAL
+    if (h > 0) {
+        shmemxa_usage_by_index((shmemx_heap_index_t) h, up);
+        return;
+        /* NOT REACHED */
+    }
+#endif  /* ENABLE_EXPERIMENTAL */
+
+    shmema_usage(up);
+}
+
+/*
+ * share of the free space that can't go to one allocation: 0 means
+ * it's all in one piece
+ */
+double
+heapstats_fragmentation(const shmema_usage_t *up)
+{
+    if (up->free == 0) {
+        return 0.0;
+        /* NOT REACHED */
+    }
+
+    return 1.0 - ((double) up->largest_free / (double) up->free);
+}
+
+void
+heapstats_output(FILE *strm, const char *prefix)
+{
+    const size_t n = heapstats_nheaps();
+    size_t h;
+
+    fprintf(strm, "%sSymmetric heap usage on PE %d:\n", prefix, proc.rank);
+    fprintf(strm, "%s\n", prefix);
+    fprintf(strm, "%s%-12s %8s %8s %8s %8s %6s %8s %8s %8s\n",
+            prefix,
+            "Heap", "Size", "Used", "Free", "Largest", "Frag",
+            "Blocks", "Allocs", "Peak");
+
+    for (h = 0; h < n; ++h) {
+        shmema_usage_t u;
+        char size[BUFSIZE], used[BUFSIZE], avail[BUFSIZE];
+        char largest[BUFSIZE], peak[BUFSIZE];
+
+        heapstats_get(h, &u);
+
+        (void) shmemu_human_number(u.capacity, size, BUFSIZE);
+        (void) shmemu_human_number(u.used, used, BUFSIZE);
+        (void) shmemu_human_number(u.free, avail, BUFSIZE);
+        (void) shmemu_human_number(u.largest_free, largest, BUFSIZE);
+        (void) shmemu_human_number(u.peak, peak, BUFSIZE);
+
+        fprintf(strm, "%s%-12s %8s %8s %8s %8s %5.1f%% %8lu %8lu %8s\n",
+                prefix,
+                proc.env.heaps.names[h],
+                size, used, avail, largest,
+                100.0 * heapstats_fragmentation(&u),
+                (unsigned long) u.blocks,
+                (unsigned long) u.allocs,
+                peak);
+    }
+
+    fprintf(strm, "%s\n", prefix);
+    fflush(strm);
+}
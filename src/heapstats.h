@@ -0,0 +1,17 @@
+/* For license: see LICENSE file at top-level */
+
+#ifndef _SHMEM_HEAPSTATS_H
+#define _SHMEM_HEAPSTATS_H 1
+
+#include "allocator/memalloc.h"
+
+#include <stdio.h>
+#include <sys/types.h>          /* size_t */
+
+size_t heapstats_nheaps(void);
+void heapstats_get(size_t h, shmema_usage_t *up);
+double heapstats_fragmentation(const shmema_usage_t *up);
+
+void heapstats_output(FILE *strm, const char *prefix);
+
+#endif  /* ! _SHMEM_HEAPSTATS_H */
@@ -11,12 +11,15 @@
 #include "threading.h"
 #include "shmem_mutex.h"
 #include "progress.h"
+#include "heapgrow.h"
+#include "heapstats.h"
 #include "collectives/collectives.h"
 #ifdef ENABLE_ALIGNED_ADDRESSES
 # include "asr.h"
 #endif /* ENABLE_ALIGNED_ADDRESSES */
 
 #ifdef ENABLE_EXPERIMENTAL
+#include "allocator/memalloc.h"
 #include "allocator/xmemalloc.h"
 #endif  /* ENABLE_EXPERIMENTAL */
 
@@ -68,7 +71,12 @@ finalize_helper(void)
     /* implicit barrier on finalize */
     shmem_barrier_all();
 
+    if ((proc.env.print_info || proc.env.heap_stats) && (proc.rank == 0)) {
+        heapstats_output(stdout, "# ");
+    }
+
     progress_finalize();
+    heapgrow_finalize();
     shmemc_finalize();
     collectives_finalize();
     /* don't need a shmemt_finalize() */
@@ -82,6 +90,104 @@ finalize_helper(void)
     proc.status = SHMEMC_PE_SHUTDOWN;
 }
 
+#ifdef ENABLE_EXPERIMENTAL
+
+/*
+ * hand the registered heaps to the allocator: heap #0 is already
+ * managed by shmema, the rest get their own spaces.  Heap H is
+ * memory region H + 1.
+ */
+
+static void
+heaps_init(void)
+{
+    size_t h;
+
+    shmemxa_init(proc.env.heaps.nheaps);
+
+    shmemxa_share_by_index(0, proc.env.heaps.names[0], shmema_base());
+
+    for (h = 1; h < proc.env.heaps.nheaps; ++h) {
+        const mem_info_t *mip = & proc.comms.regions[h + 1].minfo[proc.rank];
+
+        shmemxa_init_by_index(h, proc.env.heaps.names[h],
+                              (void *) mip->base, mip->len);
+    }
+}
+
+#endif  /* ENABLE_EXPERIMENTAL */
+
+/*
+ * how long did start-up take, across all PEs?  Collective.
+ */
+
+static void
+startup_profile_output(FILE *strm, const char *prefix)
+{
+    const char *names[SHMEMC_MAX_STARTUP_PHASES];
+    double secs[SHMEMC_MAX_STARTUP_PHASES];
+    const int n = shmemc_startup_phases(names, secs,
+                                        SHMEMC_MAX_STARTUP_PHASES);
+    const int nred = n + 1;     /* phases, plus total */
+    const int nwrk = (nred / 2 + 1 > SHMEM_REDUCE_MIN_WRKDATA_SIZE) ?
+        nred / 2 + 1 : SHMEM_REDUCE_MIN_WRKDATA_SIZE;
+    double *src, *mins, *maxs, *sums, *wrk;
+    long *sync;
+    int i;
+
+    src  = (double *) shmem_malloc(4 * nred * sizeof(*src));
+    wrk  = (double *) shmem_malloc(nwrk * sizeof(*wrk));
+    sync = (long *) shmem_malloc(SHMEM_REDUCE_SYNC_SIZE * sizeof(*sync));
+    shmemu_assert((src != NULL) && (wrk != NULL) && (sync != NULL),
+                  "can't allocate memory for start-up profile");
+
+    mins = src + nred;
+    maxs = mins + nred;
+    sums = maxs + nred;
+
+    src[n] = 0.0;
+    for (i = 0; i < n; ++i) {
+        src[i] = secs[i];
+        src[n] += secs[i];
+    }
+    for (i = 0; i < SHMEM_REDUCE_SYNC_SIZE; ++i) {
+        sync[i] = SHMEM_SYNC_VALUE;
+    }
+    shmem_barrier_all();
+
+    shmem_double_min_to_all(mins, src, nred,
+                            0, 0, proc.nranks, wrk, sync);
+    shmem_barrier_all();
+    shmem_double_max_to_all(maxs, src, nred,
+                            0, 0, proc.nranks, wrk, sync);
+    shmem_barrier_all();
+    shmem_double_sum_to_all(sums, src, nred,
+                            0, 0, proc.nranks, wrk, sync);
+
+    if (proc.rank == 0) {
+        fprintf(strm, "%sStart-up profile (%s bootstrap, %d PEs), "
+                "seconds:\n",
+                prefix,
+                shmemc_bootstrap_name(proc.env.bootstrap),
+                proc.nranks);
+        fprintf(strm, "%s\n", prefix);
+        fprintf(strm, "%s%-12s %12s %12s %12s\n",
+                prefix, "Phase", "Min", "Avg", "Max");
+        for (i = 0; i < nred; ++i) {
+            fprintf(strm, "%s%-12s %12.6f %12.6f %12.6f\n",
+                    prefix,
+                    (i < n) ? names[i] : "total",
+                    mins[i], sums[i] / proc.nranks, maxs[i]);
+        }
+        fprintf(strm, "%s\n", prefix);
+        fflush(strm);
+    }
+
+    shmem_free(sync);
+    shmem_free(wrk);
+    shmem_free(src);
+}
+
 inline static int
 init_thread_helper(int requested, int *provided)
 {
@@ -123,9 +229,10 @@ init_thread_helper(int requested, int *provided)
     shmemu_init();
     collectives_init();
     progress_init();
+    heapgrow_init();
 
 #ifdef ENABLE_EXPERIMENTAL
-    shmemxa_init(proc.env.heaps.nheaps);
+    heaps_init();
 #endif  /* ENABLE_EXPERIMENTAL */
 
     s = atexit(finalize_helper);
@@ -159,8 +266,17 @@ init_thread_helper(int requested, int *provided)
     test_asr_mismatch();
 #endif /* ENABLE_ALIGNED_ADDRESSES */
 
+    shmemc_startup_phase("library");
+
     /* make sure all symmetric memory ready */
     shmem_barrier_all();
+    shmemc_startup_phase("barrier");
+
+    shmemc_report_startup();
+
+    if (proc.env.print_info || proc.env.startup_profile) {
+        startup_profile_output(stdout, "# ");
+    }
 
     /* just declare success */
     return 0;
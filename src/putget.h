@@ -164,9 +164,6 @@
                              ptrdiff_t tst, ptrdiff_t sst,              \
                              size_t nelems, int pe)                     \
     {                                                                   \
-        size_t ti = 0, si = 0;                                          \
-        size_t i;                                                       \
-                                                                        \
         SHMEMU_CHECK_INIT();                                            \
         SHMEMU_CHECK_PE_ARG_RANGE(pe, 7);                               \
         SHMEMU_CHECK_SYMMETRIC(target, 2);                              \
@@ -179,14 +176,11 @@
                nelems, pe                                               \
                );                                                       \
                                                                         \
-        for (i = 0; i < nelems; ++i) {                                  \
-            shmem_ctx_##_name##_put(ctx,                                \
-                                    &(target[ti]),                      \
-                                    &(source[si]),                      \
-                                    1, pe);                             \
-            ti += tst;                                                  \
-            si += sst;                                                  \
-        }                                                               \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_iput(ctx,                     \
+                                               target, source,          \
+                                               sizeof(_type),           \
+                                               tst, sst,                \
+                                               nelems, pe));            \
     }
 
 #define SHMEM_CTX_TYPED_IGET(_name, _type)                              \
@@ -196,9 +190,6 @@
                              ptrdiff_t tst, ptrdiff_t sst,              \
                              size_t nelems, int pe)                     \
     {                                                                   \
-        size_t ti = 0, si = 0;                                          \
-        size_t i;                                                       \
-                                                                        \
         SHMEMU_CHECK_INIT();                                            \
         SHMEMU_CHECK_PE_ARG_RANGE(pe, 7);                               \
         SHMEMU_CHECK_SYMMETRIC(source, 3);                              \
@@ -211,14 +202,11 @@
                nelems, pe                                               \
                );                                                       \
                                                                         \
-        for (i = 0; i < nelems; ++i) {                                  \
-            shmem_ctx_##_name##_get(ctx,                                \
-                                    &(target[ti]),                      \
-                                    &(source[si]),                      \
-                                    1, pe);                             \
-            ti += tst;                                                  \
-            si += sst;                                                  \
-        }                                                               \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_iget(ctx,                     \
+                                               target, source,          \
+                                               sizeof(_type),           \
+                                               tst, sst,                \
+                                               nelems, pe));            \
     }
 
 #define SHMEM_CTX_SIZED_IPUT(_size)                                     \
@@ -228,11 +216,6 @@
                           ptrdiff_t tst, ptrdiff_t sst,                 \
                           size_t nelems, int pe)                        \
     {                                                                   \
-        const size_t tst_nb = BITS2BYTES(_size) * tst;                  \
-        const size_t sst_nb = BITS2BYTES(_size) * sst;                  \
-        size_t ti = 0, si = 0;                                          \
-        size_t i;                                                       \
-                                                                        \
         SHMEMU_CHECK_INIT();                                            \
         SHMEMU_CHECK_PE_ARG_RANGE(pe, 7);                               \
         SHMEMU_CHECK_SYMMETRIC(target, 2);                              \
@@ -245,14 +228,11 @@
                nelems, pe                                               \
                );                                                       \
                                                                         \
-        for (i = 0; i < nelems; ++i) {                                  \
-            shmem_ctx_put##_size(ctx,                                   \
-                                 (void *) &((char *) target)[ti],       \
-                                 (void *) &((char *) source)[si],       \
-                                 1, pe);                                \
-            ti += tst_nb;                                               \
-            si += sst_nb;                                               \
-        }                                                               \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_iput(ctx,                     \
+                                               target, source,          \
+                                               BITS2BYTES(_size),       \
+                                               tst, sst,                \
+                                               nelems, pe));            \
     }
 
 #define SHMEM_CTX_SIZED_IGET(_size)                                     \
@@ -262,11 +242,6 @@
                           ptrdiff_t tst, ptrdiff_t sst,                 \
                           size_t nelems, int pe)                        \
     {                                                                   \
-        const size_t tst_nb = BITS2BYTES(_size) * tst;                  \
-        const size_t sst_nb = BITS2BYTES(_size) * sst;                  \
-        size_t ti = 0, si = 0;                                          \
-        size_t i;                                                       \
-                                                                        \
         SHMEMU_CHECK_INIT();                                            \
         SHMEMU_CHECK_PE_ARG_RANGE(pe, 7);                               \
         SHMEMU_CHECK_SYMMETRIC(source, 3);                              \
@@ -280,14 +255,11 @@
                );                                                       \
                                                                         \
                                                                         \
-        for (i = 0; i < nelems; ++i) {                                  \
-            shmem_ctx_get##_size(ctx,                                   \
-                                 (void *) &((char *) target)[ti],       \
-                                 (void *) &((char *) source)[si],       \
-                                 1, pe);                                \
-            ti += tst_nb;                                               \
-            si += sst_nb;                                               \
-        }                                                               \
+        SHMEMT_MUTEX_NOPROTECT(shmemc_ctx_iget(ctx,                     \
+                                               target, source,          \
+                                               BITS2BYTES(_size),       \
+                                               tst, sst,                \
+                                               nelems, pe));            \
     }
 
 #define SHMEM_CTX_TYPED_PUT_NBI(_name, _type)                       \
@@ -7,13 +7,111 @@
 #include "shmemu.h"
 #include "shmemc.h"
 #include "shmem/api.h"
+#include "shmemx.h"
 
 #include "shmem_mutex.h"
 #include "allocator/memalloc.h"
+#ifdef ENABLE_EXPERIMENTAL
+# include "allocator/xmemalloc.h"
+#endif  /* ENABLE_EXPERIMENTAL */
+#include "heapgrow.h"
 
 #include <stdio.h>
 #include <sys/types.h>
 #include <stdlib.h>
+#include <string.h>
+
+/*
+ * If an allocation failed on any PE and the heap can grow, grow it on
+ * all of them and try again.  Everyone gives back what they got
+ * first, so the retry stays symmetric.
+ */
+#define ALLOC_GROWING(_addr, _bytes, _alloc)                            \
+    do {                                                                \
+        size_t need;                                                    \
+                                                                        \
+        while ((need = heapgrow_needed(_addr, _bytes)) > 0) {           \
+            if ((_addr) != NULL) {                                      \
+                SHMEMT_MUTEX_PROTECT(shmema_free(_addr));               \
+            }                                                           \
+            if (! heapgrow_extend(need)) {                              \
+                (_addr) = NULL;                                         \
+                break;                                                  \
+            }                                                           \
+            SHMEMT_MUTEX_PROTECT((_addr) = (_alloc));                   \
+        }                                                               \
+    } while (0)
+
+/*
+ * In deferred-free mode, freed blocks go back to the heap at the next
+ * barrier.  If any are waiting, have that barrier now so they can be
+ * reused.  Every PE has queued the same frees, so they all join in.
+ */
+inline static void
+reclaim_deferred(void)
+{
+    if (shmema_deferred() > 0) {
+        shmem_barrier_all();    /* reclaims on the way out */
+    }
+}
+
+/*
+ * Allocation hints.  Targets of remote atomics and signals get whole
+ * cache lines to themselves, so remote updates never fight bulk data
+ * over a line.  With SHMEM_HEAPS they also go in the heap called
+ * "atomics", if there is one.  Read-mostly bulk data goes in the
+ * heap called "bulk", or else the first heap with huge pages.
+ * Otherwise everything comes from the default heap.
+ */
+
+#define CACHELINE 64
+
+#define HINTS_PADDED                                            \
+    (SHMEM_MALLOC_ATOMICS_REMOTE | SHMEM_MALLOC_SIGNAL_REMOTE)
+
+#ifdef ENABLE_EXPERIMENTAL
+
+inline static shmemx_heap_index_t
+hinted_heap(long hints)
+{
+    shmemx_heap_index_t idx = -1;
+
+    if (hints & HINTS_PADDED) {
+        idx = shmemxa_name_to_index("atomics");
+    }
+    else if (hints & SHMEMX_MALLOC_BULK_READ_MOSTLY) {
+        size_t h;
+
+        idx = shmemxa_name_to_index("bulk");
+
+        for (h = 1; (idx < 0) && (h < proc.env.heaps.nheaps); ++h) {
+            if (proc.env.heaps.pagesize[h] != 0) {
+                idx = (shmemx_heap_index_t) h;
+            }
+        }
+    }
+
+    /* the default heap is handled here */
+    return (idx > 0) ? idx : -1;
+}
+
+/*
+ * Hinted blocks can live in other heaps.  Those don't grow or defer
+ * frees.
+ */
+
+inline static shmemx_heap_index_t
+other_heap(void *p)
+{
+    return shmemxa_addr_to_index(p);
+}
+
+#else
+
+# define hinted_heap(_hints) (-1)
+# define other_heap(_p) (-1)
+
+#endif  /* ENABLE_EXPERIMENTAL */
 
 /*
  * -- API --------------------------------------------------------------------
@@ -43,10 +141,36 @@ shmem_malloc_private(size_t s)
         return NULL;
     }
 
+    reclaim_deferred();
+
     SHMEMT_MUTEX_PROTECT(addr = shmema_malloc(s));
 
     shmem_barrier_all();
 
+    ALLOC_GROWING(addr, s, shmema_malloc(s));
+
+    SHMEMU_CHECK_ALLOC(addr, s);
+
+    return addr;
+}
+
+inline static void *
+shmem_align_private(size_t a, size_t s)
+{
+    void *addr;
+
+    if (shmemu_unlikely(s == 0)) {
+        return NULL;
+    }
+
+    reclaim_deferred();
+
+    SHMEMT_MUTEX_PROTECT(addr = shmema_align(a, s));
+
+    shmem_barrier_all();
+
+    ALLOC_GROWING(addr, s + a, shmema_align(a, s));
+
     SHMEMU_CHECK_ALLOC(addr, s);
 
     return addr;
@@ -71,16 +195,37 @@ shmem_malloc(size_t s)
 void *
 shmem_malloc_with_hints(size_t s, long hints)
 {
+    const int h = hinted_heap(hints);
+    const bool padded = (hints & HINTS_PADDED) != 0;
+    size_t want = s;
     void *addr;
 
-    NO_WARN_UNUSED(hints);
+    if (padded) {
+        want = (s + CACHELINE - 1) & ~(CACHELINE - 1);
+    }
 
-    addr = shmem_malloc_private(s);
+#ifdef ENABLE_EXPERIMENTAL
+    if ((h > 0) && (s > 0)) {
+        SHMEMT_MUTEX_PROTECT(addr = padded ?
+                             shmemxa_align_by_index(h, CACHELINE, want) :
+                             shmemxa_malloc_by_index(h, want));
+
+        shmem_barrier_all();
+    }
+    else
+#endif  /* ENABLE_EXPERIMENTAL */
+    if (padded) {
+        addr = shmem_align_private(CACHELINE, want);
+    }
+    else {
+        addr = shmem_malloc_private(s);
+    }
 
     logger(LOG_MEMORY,
-           "%s(size=%lu) -> %p",
+           "%s(size=%lu, hints=%#lx) -> %p [heap %d%s]",
            __func__,
-           (unsigned long) s, addr
+           (unsigned long) s, (unsigned long) hints, addr,
+           (h > 0) ? h : 0, padded ? ", padded" : ""
            );
 
     return addr;
@@ -95,10 +240,14 @@ shmem_calloc(size_t n, size_t s)
         return NULL;
     }
 
+    reclaim_deferred();
+
     SHMEMT_MUTEX_PROTECT(addr = shmema_calloc(n, s));
 
     shmem_barrier_all();
 
+    ALLOC_GROWING(addr, n * s, shmema_calloc(n, s));
+
     logger(LOG_MEMORY,
            "%s(count=%lu, size=%lu) -> %p",
            __func__,
@@ -113,6 +262,37 @@ shmem_calloc(size_t n, size_t s)
 void
 shmem_free(void *p)
 {
+    const int h = other_heap(p);
+
+#ifdef ENABLE_EXPERIMENTAL
+    if (h > 0) {
+        shmem_barrier_all();
+
+        SHMEMT_MUTEX_PROTECT(shmemxa_free_by_index(h, p));
+
+        logger(LOG_MEMORY, "%s(addr=%p) [heap %d]", __func__, p, h);
+        return;
+        /* NOT REACHED */
+    }
+#else
+    NO_WARN_UNUSED(h);
+#endif  /* ENABLE_EXPERIMENTAL */
+
+    /* no barrier: nobody can reuse it until the next one */
+    if (proc.env.deferred_free) {
+        int s;
+
+        SHMEMT_MUTEX_PROTECT(s = shmema_free_deferred(p));
+        if (s != 0) {
+            shmemu_fatal("can't queue deferred free of %p", p);
+            /* NOT REACHED */
+        }
+
+        logger(LOG_MEMORY, "%s(addr=%p) [deferred]", __func__, p);
+        return;
+        /* NOT REACHED */
+    }
+
     shmem_barrier_all();
 
     SHMEMT_MUTEX_PROTECT(shmema_free(p));
@@ -120,6 +300,32 @@ shmem_free(void *p)
     logger(LOG_MEMORY, "%s(addr=%p)", __func__, p);
 }
 
+/*
+ * A realloc that worked on some PEs and not others can't be undone,
+ * and retrying only where it failed would put the block somewhere
+ * else there.  So if the heap can grow, move the block instead:
+ * allocate (growing on all PEs or none), copy, free the old one.
+ * Every PE does the same thing, so the heap stays symmetric.
+ */
+static void *
+realloc_moving(void *p, size_t s)
+{
+    void *addr;
+
+    SHMEMT_MUTEX_PROTECT(addr = shmema_malloc(s));
+
+    ALLOC_GROWING(addr, s, shmema_malloc(s));
+
+    if ((addr != NULL) && (p != NULL)) {
+        const size_t old = shmema_usable_size(p);
+
+        memcpy(addr, p, (old < s) ? old : s);
+        SHMEMT_MUTEX_PROTECT(shmema_free(p));
+    }
+
+    return addr;
+}
+
 /*
  * realloc can cause memory to move around, so we protect it before
  * *and* after (spec 1.4, p. 25)
@@ -136,7 +342,33 @@ shmem_realloc(void *p, size_t s)
 
     shmem_barrier_all();
 
-    SHMEMT_MUTEX_PROTECT(addr = shmema_realloc(p, s));
+#ifdef ENABLE_EXPERIMENTAL
+    {
+        const int h = other_heap(p);
+
+        if (h > 0) {
+            SHMEMT_MUTEX_PROTECT(addr = shmemxa_realloc_by_index(h, p, s));
+
+            shmem_barrier_all();
+
+            logger(LOG_MEMORY,
+                   "%s(addr=%p, size=%lu) -> %p [heap %d]",
+                   __func__,
+                   p, (unsigned long) s, addr, h
+                   );
+
+            return addr;
+            /* NOT REACHED */
+        }
+    }
+#endif  /* ENABLE_EXPERIMENTAL */
+
+    if (proc.env.heap_grow > 0) {
+        addr = realloc_moving(p, s);
+    }
+    else {
+        SHMEMT_MUTEX_PROTECT(addr = shmema_realloc(p, s));
+    }
 
     shmem_barrier_all();
 
@@ -156,13 +388,7 @@ shmem_align(size_t a, size_t s)
 {
     void *addr;
 
-    if (shmemu_unlikely(s == 0)) {
-        return NULL;
-    }
-
-    SHMEMT_MUTEX_PROTECT(addr = shmema_align(a, s));
-
-    shmem_barrier_all();
+    addr = shmem_align_private(a, s);
 
     logger(LOG_MEMORY,
            "%s(align=%lu, size=%lu) -> %p",
@@ -170,7 +396,5 @@ shmem_align(size_t a, size_t s)
            (unsigned long) a, (unsigned long) s, addr
            );
 
-    SHMEMU_CHECK_ALLOC(addr, s);
-
     return addr;
 }
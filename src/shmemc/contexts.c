@@ -12,6 +12,7 @@
 #include "ucx/api.h"
 
 #include "shmem/defs.h"
+#include "shmemx.h"
 
 #include "klib/klist.h"
 
@@ -166,6 +167,69 @@ context_set_options(long options, shmemc_context_h ch)
     ch->attr.serialized = options & SHMEM_CTX_SERIALIZED;
     ch->attr.private    = options & SHMEM_CTX_PRIVATE;
     ch->attr.nostore    = options & SHMEM_CTX_NOSTORE;
+
+    /* endpoint tracking isn't locked, so one thread at a time */
+    ch->dirty.enabled   =
+        ch->attr.private || ch->attr.serialized ||
+        (proc.td.osh_tl != SHMEM_THREAD_MULTIPLE);
+
+    /* nor are put buffers */
+    ch->attr.coalesce   =
+        (options & SHMEMX_CTX_COALESCE) &&
+        (ch->attr.private || ch->attr.serialized);
+
+    if ((options & SHMEMX_CTX_COALESCE) && ! ch->attr.coalesce) {
+        logger(LOG_CONTEXTS,
+               "put coalescing needs a private or serialized context, "
+               "ignored");
+    }
+}
+
+/*
+ * per-PE put buffers for coalescing contexts.  The buffers
+ * themselves are allocated on first use.
+ */
+
+inline static void
+context_combine_init(shmemc_context_h ch)
+{
+    ch->combine = NULL;
+    ch->combine_pes = NULL;
+    ch->ncombine = 0;
+
+    if (ch->attr.coalesce) {
+        ch->combine = (put_combine_t *)
+            calloc(proc.nranks, sizeof(*(ch->combine)));
+        ch->combine_pes = (int *)
+            malloc(proc.nranks * sizeof(*(ch->combine_pes)));
+        if ((ch->combine == NULL) || (ch->combine_pes == NULL)) {
+            free(ch->combine);
+            free(ch->combine_pes);
+            ch->combine = NULL;
+            ch->combine_pes = NULL;
+            logger(LOG_CONTEXTS,
+                   "can't allocate put buffers for context #%lu, "
+                   "coalescing disabled",
+                   ch->id);
+            ch->attr.coalesce = false;
+        }
+    }
+}
+
+inline static void
+context_combine_finalize(shmemc_context_h ch)
+{
+    if (ch->combine != NULL) {
+        int i;
+
+        for (i = 0; i < proc.nranks; ++i) {
+            free(ch->combine[i].buf);
+        }
+        free(ch->combine);
+        free(ch->combine_pes);
+        ch->combine = NULL;
+        ch->combine_pes = NULL;
+    }
 }
 
 /*
@@ -226,6 +290,11 @@ shmemc_context_create(shmemc_team_h th, long options, shmemc_context_h *ctxp)
     ch->creator_thread = threadwrap_thread_id();
     ch->id = idx;
     ch->team = th;              /* connect context to its owning team */
+    ch->last_region = 0;        /* start lookups at globals */
+    ch->nsignals = 0;
+    ch->nfetches = 0;
+
+    context_combine_init(ch);
 
     context_register(ch);
 
@@ -255,6 +324,8 @@ shmemc_context_destroy(shmem_ctx_t ctx)
         /* spec 1.4 ++ has implicit quiet for storable contexts */
         shmemc_ctx_quiet(ch);
 
+        context_combine_finalize(ch);
+
         context_deregister(ch);
     }
 }
@@ -285,6 +356,8 @@ shmemc_context_init_default(void)
 {
     context_set_options(0L, defcp);
 
+    defcp->last_region = 0;
+
     shmemc_ucx_context_progress(defcp);
 
     return shmemc_ucx_context_default_set_info();
@@ -6,16 +6,149 @@
 
 #include "ucx/api.h"
 #include "shmemc.h"
+#include "shmemu.h"
 #include "nodename.h"
 #include "pmi_client.h"
 
+#include <time.h>
+
+/*
+ * time the phases of start-up.  The logger isn't running yet while
+ * these happen, so record them and report later.
+ */
+
+typedef struct startup_phase {
+    const char *name;
+    double secs;
+} startup_phase_t;
+
+static startup_phase_t phases[SHMEMC_MAX_STARTUP_PHASES];
+static int nphases = 0;
+static double phase_start;
+
+inline static double
+read_time(void)
+{
+    struct timespec t;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &t) != 0) {
+        return 0.0;
+        /* NOT REACHED */
+    }
+
+    return (double) t.tv_sec + (t.tv_nsec / 1.0e9);
+}
+
+/*
+ * the phase called "name" just finished, next one starts now
+ */
+
+void
+shmemc_startup_phase(const char *name)
+{
+    const double now = read_time();
+
+    if (nphases < SHMEMC_MAX_STARTUP_PHASES) {
+        phases[nphases].name = name;
+        phases[nphases].secs = now - phase_start;
+        ++nphases;
+    }
+
+    phase_start = now;
+}
+
+/*
+ * what got recorded: fill in up to "max" names & times, return count
+ */
+
+int
+shmemc_startup_phases(const char **names, double *secs, int max)
+{
+    int i;
+
+    for (i = 0; (i < nphases) && (i < max); ++i) {
+        names[i] = phases[i].name;
+        secs[i] = phases[i].secs;
+    }
+
+    return i;
+}
+
+void
+shmemc_report_startup(void)
+{
+    double total = 0.0;
+    int i;
+
+    for (i = 0; i < nphases; ++i) {
+        logger(LOG_INIT,
+               "start-up phase \"%s\" took %.6f s",
+               phases[i].name, phases[i].secs);
+        total += phases[i].secs;
+    }
+
+    logger(LOG_INIT,
+           "start-up (%s bootstrap) took %.6f s",
+           shmemc_bootstrap_name(proc.env.bootstrap),
+           total);
+}
+
+/*
+ * eager: everyone has everyone else's info before we go
+ */
+
+inline static void
+exchange_eager(void)
+{
+    shmemc_pmi_publish_bootstrap();
+    shmemc_startup_phase("publish");
+    shmemc_pmi_barrier_all(true);
+    shmemc_startup_phase("fence");
+    shmemc_pmi_exchange_bootstrap();
+    shmemc_startup_phase("exchange");
+}
+
+/*
+ * lazy: just make sure our info is out there, peers pick it up when
+ * they need it
+ */
+
+inline static void
+exchange_lazy(void)
+{
+    shmemc_pmi_publish_bootstrap();
+    shmemc_startup_phase("publish");
+    shmemc_pmi_barrier_all(false);
+    shmemc_pmi_fetch_init();
+    shmemc_startup_phase("fence");
+}
+
+/*
+ * node: leaders fetch everything and share it with their peers
+ */
+
+inline static void
+exchange_node(void)
+{
+    shmemc_pmi_publish_bootstrap();
+    shmemc_startup_phase("publish");
+    shmemc_pmi_barrier_all(false);
+    shmemc_startup_phase("fence");
+    shmemc_pmi_node_exchange();
+    shmemc_startup_phase("exchange");
+}
+
 void
 shmemc_init(void)
 {
+    nphases = 0;
+    phase_start = read_time();
+
     shmemc_nodename_init();
 
     /* find launch info */
     shmemc_pmi_client_init();
+    shmemc_startup_phase("pmi");
 
     /* launch and connect my heap to network resources */
     shmemc_ucx_init();
@@ -23,23 +156,38 @@ shmemc_init(void)
     shmemc_context_init_default();
 
     shmemc_teams_init();
+    shmemc_startup_phase("contexts");
 
     /* now heap registered... */
 
-    /* publish worker info, everyone has it and exchanges */
-    shmemc_pmi_publish_worker();
-    shmemc_pmi_barrier_all(true);
-    shmemc_pmi_exchange_workers();
-
-    /* publish rkeys (& maybe heaps), everyone has it and exchanges */
-    shmemc_pmi_publish_rkeys_and_heaps();
-    shmemc_pmi_barrier_all(true);
-    shmemc_pmi_exchange_rkeys_and_heaps();
+    /* need to know who's on this node for node bootstrap */
+    if ((proc.env.bootstrap == SHMEMC_BOOTSTRAP_NODE) &&
+        (proc.npeers < 1)) {
+        proc.env.bootstrap = SHMEMC_BOOTSTRAP_EAGER;
+    }
+
+    switch (proc.env.bootstrap) {
+    case SHMEMC_BOOTSTRAP_LAZY:
+        exchange_lazy();
+        break;
+    case SHMEMC_BOOTSTRAP_NODE:
+        exchange_node();
+        break;
+    default:
+        exchange_eager();
+        break;
+    }
 
     shmemc_ucx_make_eps(defcp);
+    shmemc_startup_phase("endpoints");
 
     /* just sync, no collect */
     shmemc_pmi_barrier_all(false);
+    shmemc_startup_phase("sync");
+
+    if (proc.env.bootstrap == SHMEMC_BOOTSTRAP_NODE) {
+        shmemc_pmi_node_release();
+    }
 }
 
 void
@@ -53,6 +201,10 @@ shmemc_finalize(void)
 
     shmemc_ucx_finalize();
 
+    shmemc_pmi_fetch_finalize();
+
+    shmemc_pmi_node_finalize();
+
     shmemc_pmi_client_finalize();
 
     shmemc_nodename_finalize();
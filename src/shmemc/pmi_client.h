@@ -11,18 +11,40 @@ void shmemc_pmi_client_abort(const char *msg, int status);
 
 void shmemc_pmi_barrier_all(bool collect_data);
 
+const char *shmemc_pmi_job_name(void);
+
 /*
  * pub
  */
 
-void shmemc_pmi_publish_worker(void);
-void shmemc_pmi_publish_rkeys_and_heaps(void);
+void shmemc_pmi_publish_bootstrap(void);
+
+/*
+ * fetch one PE's blob (caller frees)
+ */
+
+void *shmemc_pmi_fetch_bootstrap(int pe, size_t *len_p);
 
 /*
- * exchange
+ * single named values, for small agreements during start-up
  */
 
-void shmemc_pmi_exchange_workers(void);
-void shmemc_pmi_exchange_rkeys_and_heaps(void);
+void shmemc_pmi_publish_value(const char *name, uint64_t v);
+uint64_t shmemc_pmi_fetch_value(int pe, const char *name);
+
+/*
+ * common to PMI clients, in ucx/bootstrap.c
+ */
+
+void shmemc_pmi_exchange_peer(int pe);
+void shmemc_pmi_exchange_bootstrap(void);
+
+void shmemc_pmi_fetch_init(void);
+void shmemc_pmi_fetch_finalize(void);
+void shmemc_pmi_fetch_peer(int pe);
+
+void shmemc_pmi_node_exchange(void);
+void shmemc_pmi_node_release(void);
+void shmemc_pmi_node_finalize(void);
 
 #endif /* ! _SHMEMC_PMI_CLIENT_H */
@@ -9,6 +9,7 @@
 #include "shmemc.h"
 #include "boolean.h"
 #include "collectives/defaults.h"
+#include "ucx/api.h"
 
 #include <stdio.h>
 #include <stdlib.h>             /* getenv */
@@ -43,6 +44,121 @@ option_enabled_test(char *str)
     return false;
 }
 
+/*
+ * huge pages for heaps: "thp", a page size like "2M", or off
+ */
+
+static size_t
+parse_pagesize(char *str)
+{
+    size_t ps;
+
+    if (strncasecmp(str, "thp", 3) == 0) {
+        return SHMEMC_PAGESIZE_THP;
+        /* NOT REACHED */
+    }
+    if ((tolower(*str) == 'n') || (strncasecmp(str, "off", 3) == 0)) {
+        return 0;
+        /* NOT REACHED */
+    }
+    if (shmemu_parse_size(str, &ps) != 0) {
+        shmemu_fatal("Couldn't work out requested heap page size \"%s\"",
+                     str);
+        /* NOT REACHED */
+    }
+    if ((ps & (ps - 1)) != 0) {
+        shmemu_fatal("Heap page size \"%s\" is not a power of 2", str);
+        /* NOT REACHED */
+    }
+
+    return ps;
+}
+
+/*
+ * extra named heaps: "name:size[:pagesize[:numa_node]],..."
+ */
+
+static size_t
+count_heaps(const char *spec)
+{
+    size_t n = 1;
+
+    for (; *spec != '\0'; ++spec) {
+        if (*spec == ',') {
+            ++n;
+        }
+    }
+
+    return n;
+}
+
+#define HEAP_FIELDS 4
+
+static void
+parse_heap(char *desc, size_t h)
+{
+    char *fields[HEAP_FIELDS] = { desc, NULL, NULL, NULL };
+    int nf = 1;
+    char *p;
+    size_t i;
+
+    /* split by hand, strtok() would skip empty fields */
+    for (p = desc; *p != '\0'; ++p) {
+        if (*p == ':') {
+            if (nf == HEAP_FIELDS) {
+                shmemu_fatal("Too many fields in declaration of heap \"%s\"",
+                             fields[0]);
+                /* NOT REACHED */
+            }
+            *p = '\0';
+            fields[nf++] = p + 1;
+        }
+    }
+
+    if ((*fields[0] == '\0') || (fields[1] == NULL)) {
+        shmemu_fatal("Heap declaration \"%s\" needs at least "
+                     "\"name:size\"",
+                     fields[0]);
+        /* NOT REACHED */
+    }
+    for (i = 0; i < h; ++i) {
+        if (strcmp(fields[0], proc.env.heaps.names[i]) == 0) {
+            shmemu_fatal("Heap name \"%s\" is already in use",
+                         fields[0]);
+            /* NOT REACHED */
+        }
+    }
+
+    proc.env.heaps.names[h] = strdup(fields[0]); /* free@end */
+    shmemu_assert(proc.env.heaps.names[h] != NULL,
+                  "can't allocate memory for heap name");
+
+    if (shmemu_parse_size(fields[1], &proc.env.heaps.heapsize[h]) != 0) {
+        shmemu_fatal("Couldn't work out requested size \"%s\" of heap \"%s\"",
+                     fields[1], fields[0]);
+        /* NOT REACHED */
+    }
+
+    if ((fields[2] != NULL) && (*fields[2] != '\0')) {
+        proc.env.heaps.pagesize[h] = parse_pagesize(fields[2]);
+    }
+
+    proc.env.heaps.numa[h] = -1;
+    if ((fields[3] != NULL) && (*fields[3] != '\0')) {
+        char *end;
+        const long n = strtol(fields[3], &end, 10);
+
+        if ((*end != '\0') || (n < 0)) {
+            shmemu_fatal("Bad NUMA node \"%s\" for heap \"%s\"",
+                         fields[3], fields[0]);
+            /* NOT REACHED */
+        }
+        proc.env.heaps.numa[h] = (int) n;
+    }
+}
+
+#undef HEAP_FIELDS
+
 /*
  * read & save all our environment variables
  */
@@ -59,6 +175,7 @@ void
 shmemc_env_init(void)
 {
     char *e;
+    char *heaps_spec;
     int r;
 
     /*
@@ -86,12 +203,32 @@ shmemc_env_init(void)
      * heaps need a bit more handling
      */
 
-    proc.env.heaps.nheaps = 1;  /* TODO: will be parsed out of env */
+    CHECK_ENV(heaps_spec, HEAPS);
+
+    /* the default heap, plus any named ones */
+    proc.env.heaps.nheaps =
+        1 + ((heaps_spec != NULL) ? count_heaps(heaps_spec) : 0);
+
+    proc.env.heaps.names =
+        (char **) calloc(proc.env.heaps.nheaps,
+                         sizeof(*proc.env.heaps.names));
     proc.env.heaps.heapsize =
-        (size_t *) malloc(proc.env.heaps.nheaps *
+        (size_t *) calloc(proc.env.heaps.nheaps,
                           sizeof(*proc.env.heaps.heapsize));
-    shmemu_assert(proc.env.heaps.heapsize != NULL,
-                  "can't allocate memory for heap size declaration");
+    proc.env.heaps.pagesize =
+        (size_t *) calloc(proc.env.heaps.nheaps,
+                          sizeof(*proc.env.heaps.pagesize));
+    proc.env.heaps.numa =
+        (int *) malloc(proc.env.heaps.nheaps *
+                       sizeof(*proc.env.heaps.numa));
+    shmemu_assert((proc.env.heaps.names != NULL) &&
+                  (proc.env.heaps.heapsize != NULL) &&
+                  (proc.env.heaps.pagesize != NULL) &&
+                  (proc.env.heaps.numa != NULL),
+                  "can't allocate memory for heap declarations");
+
+    proc.env.heaps.names[0] = strdup(SHMEMC_DEFAULT_HEAP_NAME); /* free@end */
+    proc.env.heaps.numa[0] = -1;
 
     CHECK_ENV(e, SYMMETRIC_SIZE);
     r = shmemu_parse_size(e != NULL ? e : SHMEM_DEFAULT_HEAP_SIZE,
@@ -101,6 +238,33 @@ shmemc_env_init(void)
                      e != NULL ? e : "(null)");
     }
 
+    CHECK_ENV(e, SYMMETRIC_HUGEPAGES);
+    if (e != NULL) {
+        proc.env.heaps.pagesize[0] = parse_pagesize(e);
+    }
+
+    if (heaps_spec != NULL) {
+        char *spec = strdup(heaps_spec);
+        char *desc = spec;
+        size_t h;
+
+        shmemu_assert(spec != NULL,
+                      "can't allocate memory to parse heap declarations");
+
+        for (h = 1; h < proc.env.heaps.nheaps; ++h) {
+            char *comma = strchr(desc, ',');
+
+            if (comma != NULL) {
+                *comma = '\0';
+            }
+            parse_heap(desc, h);
+
+            desc = comma + 1;   /* not used after last heap */
+        }
+
+        free(spec);
+    }
+
     /*
      * this implementation also has...
      */
@@ -206,6 +370,141 @@ shmemc_env_init(void)
     if (e != NULL) {
         proc.env.memfatal = option_enabled_test(e);
     }
+
+    proc.env.shared_direct = false;
+
+    CHECK_ENV(e, SHARED_DIRECT);
+    if (e != NULL) {
+        proc.env.shared_direct = option_enabled_test(e);
+    }
+
+    proc.env.bootstrap = SHMEMC_BOOTSTRAP_EAGER;
+
+    CHECK_ENV(e, BOOTSTRAP);
+    if (e != NULL) {
+        if (strncasecmp(e, "lazy", 4) == 0) {
+            proc.env.bootstrap = SHMEMC_BOOTSTRAP_LAZY;
+        }
+        else if (strncasecmp(e, "node", 4) == 0) {
+            proc.env.bootstrap = SHMEMC_BOOTSTRAP_NODE;
+        }
+        else if (strncasecmp(e, "eager", 5) != 0) {
+            shmemu_fatal("Unknown bootstrap mode \"%s\"", e);
+            /* NOT REACHED */
+        }
+    }
+
+    proc.env.bootstrap_prefetch = 1;
+
+    CHECK_ENV(e, BOOTSTRAP_PREFETCH);
+    if (e != NULL) {
+        long n = strtol(e, NULL, 10);
+
+        if (n < 1) {
+            n = proc.env.bootstrap_prefetch;
+        }
+        proc.env.bootstrap_prefetch = (size_t) n;
+    }
+
+    proc.env.startup_profile = false;
+
+    CHECK_ENV(e, STARTUP_PROFILE);
+    if (e != NULL) {
+        proc.env.startup_profile = option_enabled_test(e);
+    }
+
+    proc.env.heap_numa = SHMEMC_NUMA_NONE;
+
+    CHECK_ENV(e, HEAP_NUMA);
+    if (e != NULL) {
+        if (strncasecmp(e, "local", 5) == 0) {
+            proc.env.heap_numa = SHMEMC_NUMA_LOCAL;
+        }
+        else if (strncasecmp(e, "interleave", 10) == 0) {
+            proc.env.heap_numa = SHMEMC_NUMA_INTERLEAVE;
+        }
+        else if (strncasecmp(e, "none", 4) != 0) {
+            shmemu_fatal("Unknown heap NUMA placement \"%s\"", e);
+            /* NOT REACHED */
+        }
+    }
+
+    proc.env.heap_prefault = 0;
+
+    CHECK_ENV(e, HEAP_PREFAULT);
+    if (e != NULL) {
+        long n = strtol(e, NULL, 10);
+
+        /* "y" etc. means 1 thread */
+        if (n < 1) {
+            n = option_enabled_test(e) ? 1 : 0;
+        }
+        proc.env.heap_prefault = (size_t) n;
+    }
+
+    proc.env.heap_grow = 0;
+
+    CHECK_ENV(e, SYMMETRIC_GROW);
+    if (e != NULL) {
+        r = shmemu_parse_size(e, &proc.env.heap_grow);
+        if (r != 0) {
+            shmemu_fatal("Couldn't work out requested heap growth \"%s\"",
+                         e);
+            /* NOT REACHED */
+        }
+#ifdef ENABLE_ALIGNED_ADDRESSES
+        /* new regions won't line up across PEs */
+        if (proc.env.heap_grow > 0) {
+            shmemu_warn("symmetric heap can't grow with aligned addresses, "
+                        "ignoring SHMEM_SYMMETRIC_GROW");
+            proc.env.heap_grow = 0;
+        }
+#endif  /* ENABLE_ALIGNED_ADDRESSES */
+    }
+
+    proc.env.heap_same_va = false;
+
+    CHECK_ENV(e, HEAP_SAME_VA);
+    if (e != NULL) {
+        proc.env.heap_same_va = option_enabled_test(e);
+    }
+
+    proc.env.globals_section = false;
+
+    CHECK_ENV(e, GLOBALS_SECTION);
+    if (e != NULL) {
+        proc.env.globals_section = option_enabled_test(e);
+    }
+
+    proc.env.deferred_free = false;
+
+    CHECK_ENV(e, DEFERRED_FREE);
+    if (e != NULL) {
+        proc.env.deferred_free = option_enabled_test(e);
+    }
+
+    proc.env.heap_stats = false;
+
+    CHECK_ENV(e, HEAP_STATS);
+    if (e != NULL) {
+        proc.env.heap_stats = option_enabled_test(e);
+    }
+
+    CHECK_ENV(e, BOUNCE_SIZE);
+    r = shmemu_parse_size(e != NULL ? e : "0", &proc.env.bounce_size);
+    if (r != 0) {
+        shmemu_fatal("Couldn't work out requested bounce pool size \"%s\"",
+                     e);
+        /* NOT REACHED */
+    }
+
+    CHECK_ENV(e, BOUNCE_MAX);
+    r = shmemu_parse_size(e != NULL ? e : "64K", &proc.env.bounce_max);
+    if (r != 0) {
+        shmemu_fatal("Couldn't work out largest staged put \"%s\"",
+                     e);
+        /* NOT REACHED */
+    }
 }
 
 #undef CHECK_ENV
@@ -229,7 +528,47 @@ shmemc_env_finalize(void)
 
     free(proc.env.progress_threads);
 
+    {
+        size_t h;
+
+        for (h = 0; h < proc.env.heaps.nheaps; ++h) {
+            free(proc.env.heaps.names[h]);
+        }
+    }
+    free(proc.env.heaps.numa);
+    free(proc.env.heaps.pagesize);
     free(proc.env.heaps.heapsize);
+    free(proc.env.heaps.names);
+}
+
+const char *
+shmemc_bootstrap_name(shmemc_bootstrap_t b)
+{
+    switch (b) {
+    case SHMEMC_BOOTSTRAP_EAGER:
+        return "eager";
+    case SHMEMC_BOOTSTRAP_LAZY:
+        return "lazy";
+    case SHMEMC_BOOTSTRAP_NODE:
+        return "node";
+    default:
+        return "unknown";
+    }
+}
+
+const char *
+shmemc_numa_name(shmemc_numa_t n)
+{
+    switch (n) {
+    case SHMEMC_NUMA_NONE:
+        return "none";
+    case SHMEMC_NUMA_LOCAL:
+        return "local";
+    case SHMEMC_NUMA_INTERLEAVE:
+        return "interleave";
+    default:
+        return "unknown";
+    }
 }
 
 /*
@@ -252,6 +591,34 @@ hr(FILE *stream, const char *prefix)
     fprintf(stream, "\n");
 }
 
+/*
+ * page size asked for heap H, and what it actually got (heap H is
+ * region H + 1)
+ */
+
+static void
+heap_pagesize_strings(size_t h, char *wbuf, char *gbuf)
+{
+    const size_t want = proc.env.heaps.pagesize[h];
+    const size_t got = proc.comms.regions[h + 1].minfo[proc.rank].pagesize;
+
+    if (want == SHMEMC_PAGESIZE_THP) {
+        STRNCPY_SAFE(wbuf, "thp", BUFSIZE);
+    }
+    else if (want == 0) {
+        STRNCPY_SAFE(wbuf, "no", BUFSIZE);
+    }
+    else {
+        (void) shmemu_human_number(want, wbuf, BUFSIZE);
+    }
+    if (got == 0) {
+        STRNCPY_SAFE(gbuf, "UCX default", BUFSIZE);
+    }
+    else {
+        (void) shmemu_human_number(got, gbuf, BUFSIZE);
+    }
+}
+
 void
 shmemc_print_env_vars(FILE *stream, const char *prefix)
 {
@@ -291,6 +658,20 @@ shmemc_print_env_vars(FILE *stream, const char *prefix)
                 val_width, buf,
                 "requested size of the symmetric heap");
     }
+    {
+        char wbuf[BUFSIZE];
+        char gbuf[BUFSIZE];
+
+        heap_pagesize_strings(0, wbuf, gbuf);
+
+        fprintf(stream, "%s%-*s %-*s %s%s%s\n",
+                prefix,
+                var_width, "SHMEM_SYMMETRIC_HUGEPAGES",
+                val_width, wbuf,
+                "huge pages for the symmetric heap (using ",
+                gbuf,
+                ")");
+    }
     fprintf(stream, "%s%-*s %-*s %s\n",
             prefix,
             var_width, "SHMEM_DEBUG",
@@ -307,6 +688,41 @@ shmemc_print_env_vars(FILE *stream, const char *prefix)
             prefix,
             "Specific to this implementation:");
     fprintf(stream, "%s\n", prefix);
+    {
+        char buf[BUFSIZE];
+        size_t h;
+
+        snprintf(buf, BUFSIZE, "%lu",
+                 (unsigned long) (proc.env.heaps.nheaps - 1));
+        fprintf(stream, "%s%-*s %-*s %s\n",
+                prefix,
+                var_width, "SHMEM_HEAPS",
+                val_width, buf,
+                "extra named symmetric heaps");
+
+        for (h = 1; h < proc.env.heaps.nheaps; ++h) {
+            char wbuf[BUFSIZE];
+            char gbuf[BUFSIZE];
+            char nbuf[BUFSIZE];
+
+            (void) shmemu_human_number(proc.env.heaps.heapsize[h],
+                                       buf, BUFSIZE);
+            heap_pagesize_strings(h, wbuf, gbuf);
+            if (proc.env.heaps.numa[h] < 0) {
+                STRNCPY_SAFE(nbuf, "any", BUFSIZE);
+            }
+            else {
+                snprintf(nbuf, BUFSIZE, "%d", proc.env.heaps.numa[h]);
+            }
+
+            fprintf(stream, "%s  %-*s %-*s #%lu, pages %s (using %s), "
+                    "NUMA node %s\n",
+                    prefix,
+                    var_width - 2, proc.env.heaps.names[h],
+                    val_width, buf,
+                    (unsigned long) h, wbuf, gbuf, nbuf);
+        }
+    }
     fprintf(stream, "%s%-*s %-*s %s\n",
             prefix,
             var_width, "SHMEM_LOGGING",
@@ -376,6 +792,105 @@ shmemc_print_env_vars(FILE *stream, const char *prefix)
             var_width, "SHMEM_MEMERR_FATAL",
             val_width, proc.env.memfatal ? "yes" : "no",
             "abort if symmetric memory corruption");
+    fprintf(stream, "%s%-*s %-*s %s\n",
+            prefix,
+            var_width, "SHMEM_SHARED_DIRECT",
+            val_width, shmemu_human_option(proc.env.shared_direct),
+            "load/store access to PEs on same node ("
+#if ! defined(HAVE_UCP_RKEY_PTR)
+            "not "
+#endif /* ! HAVE_UCP_RKEY_PTR */
+            "available)"
+            );
+    fprintf(stream, "%s%-*s %-*s %s\n",
+            prefix,
+            var_width, "SHMEM_BOOTSTRAP",
+            val_width, shmemc_bootstrap_name(proc.env.bootstrap),
+            "how PEs fetch each other's info at start-up");
+    fprintf(stream, "%s%-*s %-*lu %s",
+            prefix,
+            var_width, "SHMEM_BOOTSTRAP_PREFETCH",
+            val_width, (unsigned long) proc.env.bootstrap_prefetch,
+            "PEs fetched together on first contact");
+    if (proc.env.bootstrap != SHMEMC_BOOTSTRAP_LAZY) {
+        fprintf(stream, " [not used]");
+    }
+    fprintf(stream, "\n");
+    fprintf(stream, "%s%-*s %-*s %s\n",
+            prefix,
+            var_width, "SHMEM_STARTUP_PROFILE",
+            val_width, shmemu_human_option(proc.env.startup_profile),
+            "show start-up phase timings across PEs");
+    fprintf(stream, "%s%-*s %-*s %s\n",
+            prefix,
+            var_width, "SHMEM_HEAP_NUMA",
+            val_width, shmemc_numa_name(proc.env.heap_numa),
+            "NUMA placement of symmetric heap pages");
+    fprintf(stream, "%s%-*s %-*lu %s\n",
+            prefix,
+            var_width, "SHMEM_HEAP_PREFAULT",
+            val_width, (unsigned long) proc.env.heap_prefault,
+            "threads to pre-fault heap pages at start-up");
+    {
+        char buf[BUFSIZE];
+
+        if (proc.env.heap_grow > 0) {
+            (void) shmemu_human_number(proc.env.heap_grow, buf, BUFSIZE);
+        }
+        else {
+            STRNCPY_SAFE(buf, "no", BUFSIZE);
+        }
+        fprintf(stream, "%s%-*s %-*s %s\n",
+                prefix,
+                var_width, "SHMEM_SYMMETRIC_GROW",
+                val_width, buf,
+                "grow the symmetric heap by at least this when full");
+    }
+    fprintf(stream, "%s%-*s %-*s %s",
+            prefix,
+            var_width, "SHMEM_HEAP_SAME_VA",
+            val_width, shmemu_human_option(proc.env.heap_same_va),
+            "put symmetric heaps at the same address on all PEs");
+#ifdef ENABLE_ALIGNED_ADDRESSES
+    fprintf(stream, " [not used]");
+#endif  /* ENABLE_ALIGNED_ADDRESSES */
+    fprintf(stream, "\n");
+    fprintf(stream, "%s%-*s %-*s %s\n",
+            prefix,
+            var_width, "SHMEM_GLOBALS_SECTION",
+            val_width, shmemu_human_option(proc.env.globals_section),
+            "only register SHMEM_SYMMETRIC global variables");
+    fprintf(stream, "%s%-*s %-*s %s\n",
+            prefix,
+            var_width, "SHMEM_DEFERRED_FREE",
+            val_width, shmemu_human_option(proc.env.deferred_free),
+            "shmem_free releases memory at the next barrier");
+    fprintf(stream, "%s%-*s %-*s %s\n",
+            prefix,
+            var_width, "SHMEM_HEAP_STATS",
+            val_width, shmemu_human_option(proc.env.heap_stats),
+            "report symmetric heap usage at finalize");
+    {
+        char buf[BUFSIZE];
+
+        if (proc.env.bounce_size > 0) {
+            (void) shmemu_human_number(proc.env.bounce_size, buf, BUFSIZE);
+        }
+        else {
+            STRNCPY_SAFE(buf, "no", BUFSIZE);
+        }
+        fprintf(stream, "%s%-*s %-*s %s\n",
+                prefix,
+                var_width, "SHMEM_BOUNCE_SIZE",
+                val_width, buf,
+                "registered local buffer pool");
+        (void) shmemu_human_number(proc.env.bounce_max, buf, BUFSIZE);
+        fprintf(stream, "%s%-*s %-*s %s\n",
+                prefix,
+                var_width, "SHMEM_BOUNCE_MAX",
+                val_width, buf,
+                "stage non-blocking put sources up to this size");
+    }
 
 #if 0
     fprintf(stream, "%s\n", prefix);
@@ -388,6 +903,24 @@ shmemc_print_env_vars(FILE *stream, const char *prefix)
 
     /* ---------------------------------------------------------------- */
 
+    {
+        char pbuf[BUFSIZE];
+        char sbuf[BUFSIZE];
+        size_t pb, sb;
+
+        shmemc_ucx_peer_table_memory(&pb, &sb);
+        (void) shmemu_human_number(pb, pbuf, BUFSIZE);
+        (void) shmemu_human_number(sb, sbuf, BUFSIZE);
+
+        fprintf(stream, "%s\n", prefix);
+        fprintf(stream, "%sMemory for peer worker/rkey tables: "
+                "%s in this PE, %s shared on this node\n",
+                prefix,
+                pbuf, sbuf);
+    }
+
+    /* ---------------------------------------------------------------- */
+
     fprintf(stream, "%s\n", prefix);
     hr(stream, prefix);
     fprintf(stream, "%s\n", prefix);
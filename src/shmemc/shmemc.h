@@ -24,6 +24,16 @@
 
 void shmemc_init(void);
 void shmemc_finalize(void);
+void shmemc_report_startup(void);
+
+/*
+ * start-up profiling
+ */
+
+#define SHMEMC_MAX_STARTUP_PHASES 16
+
+void shmemc_startup_phase(const char *name);
+int shmemc_startup_phases(const char **names, double *secs, int max);
 
 void shmemc_globalexit_init(void);
 void shmemc_globalexit_finalize(void);
@@ -39,6 +49,19 @@ int shmemc_addr_accessible(const void *addr, int pe);
 void shmemc_env_init(void);
 void shmemc_env_finalize(void);
 void shmemc_print_env_vars(FILE *stream, const char *prefix);
+const char *shmemc_bootstrap_name(shmemc_bootstrap_t b);
+const char *shmemc_numa_name(shmemc_numa_t n);
+
+bool shmemc_heap_extend_begin(size_t len,
+                              uint64_t *base_p, size_t *len_p,
+                              void **rkey_p, size_t *rkey_len_p);
+void shmemc_heap_extend_peer(int pe,
+                             uint64_t base, size_t len,
+                             const void *rkey, size_t rkey_len);
+void shmemc_heap_extend_end(void);
+
+void *shmemc_bounce_alloc(size_t n);
+void shmemc_bounce_free(void *p);
 
 /*
  * -- Per-context routines ---------------------------------------------------
@@ -50,6 +73,8 @@ void shmemc_progress(void);
 void shmemc_ctx_fence(shmem_ctx_t ctx);
 void shmemc_ctx_quiet(shmem_ctx_t ctx);
 
+void shmemc_ctx_coalesce_flush(shmem_ctx_t ctx);
+
 #ifdef ENABLE_EXPERIMENTAL
 
 int shmemc_ctx_fence_test(shmem_ctx_t ctx);
@@ -71,6 +96,17 @@ void shmemc_ctx_get_nbi(shmem_ctx_t ctx,
                         void *dest, const void *src,
                         size_t nbytes, int pe);
 
+void shmemc_ctx_iput(shmem_ctx_t ctx,
+                     void *dest, const void *src,
+                     size_t es,
+                     ptrdiff_t tst, ptrdiff_t sst,
+                     size_t nelems, int pe);
+void shmemc_ctx_iget(shmem_ctx_t ctx,
+                     void *dest, const void *src,
+                     size_t es,
+                     ptrdiff_t tst, ptrdiff_t sst,
+                     size_t nelems, int pe);
+
 void shmemc_ctx_put_signal(shmem_ctx_t ctx,
                            void *dest, const void *src,
                            size_t nbytes,
@@ -205,6 +241,65 @@ void shmemc_ctx_fetch(shmem_ctx_t ctx,
                       int pe,
                       void *valp);
 
+/*
+ * non-blocking fetching AMOs: fetched value only guaranteed after
+ * quiet
+ */
+
+void shmemc_ctx_swap_nbi(shmem_ctx_t ctx,
+                         void *target, void *value, size_t vals,
+                         int pe,
+                         void *retp);
+
+void shmemc_ctx_cswap_nbi(shmem_ctx_t ctx,
+                          void *target,
+                          void *cond, void *value, size_t vals,
+                          int pe,
+                          void *retp);
+
+void shmemc_ctx_fadd_nbi(shmem_ctx_t ctx,
+                         void *target, void *value, size_t vals,
+                         int pe,
+                         void *retp);
+
+#define SHMEMC_CTX_DECL_FETCH_BITWISE_NBI(_op)                          \
+    void shmemc_ctx_fetch_##_op##_nbi(shmem_ctx_t ctx,                  \
+                                      void *target,                     \
+                                      void *value, size_t vals,         \
+                                      int pe,                           \
+                                      void *retp);
+
+SHMEMC_CTX_DECL_FETCH_BITWISE_NBI(and)
+SHMEMC_CTX_DECL_FETCH_BITWISE_NBI(or)
+SHMEMC_CTX_DECL_FETCH_BITWISE_NBI(xor)
+
+/*
+ * atomics UCX doesn't do natively (float add, min/max, and bitwise
+ * on older UCX): operation and how to interpret the target
+ */
+
+typedef enum shmemc_amo_op {
+    SHMEMC_AMO_AND = 0,
+    SHMEMC_AMO_OR,
+    SHMEMC_AMO_XOR,
+    SHMEMC_AMO_ADD,
+    SHMEMC_AMO_MIN,
+    SHMEMC_AMO_MAX,
+    SHMEMC_AMO_NUM_OPS
+} shmemc_amo_op_t;
+
+typedef enum shmemc_amo_kind {
+    SHMEMC_AMO_SIGNED = 0,
+    SHMEMC_AMO_UNSIGNED,
+    SHMEMC_AMO_FLOAT
+} shmemc_amo_kind_t;
+
+void shmemc_ctx_fetch_op(shmem_ctx_t ctx,
+                         shmemc_amo_op_t op, shmemc_amo_kind_t kind,
+                         void *target, void *value, size_t vals,
+                         int pe,
+                         void *retp);
+
 /*
  * locks
  */
@@ -53,9 +53,47 @@ typedef enum shmemc_status {
 
 typedef struct heapinfo {
     size_t nheaps;              /**< how many heaps requested */
+    char **names;               /**< their names (#0 is "default") */
     size_t *heapsize;           /**< array of their sizes */
+    size_t *pagesize;           /**< page size wanted for each, or 0 */
+    int *numa;                  /**< NUMA node for each, or -1 */
 } heapinfo_t;
 
+/*
+ * pagesize that asks for transparent huge pages
+ */
+#define SHMEMC_PAGESIZE_THP ((size_t) -1)
+
+/*
+ * name of heap #0, sized by SHMEM_SYMMETRIC_SIZE
+ */
+#define SHMEMC_DEFAULT_HEAP_NAME "default"
+
+/*
+ * most times the default heap can grow (SHMEM_SYMMETRIC_GROW)
+ */
+#define SHMEMC_MAX_HEAP_EXTENSIONS 64
+
+/*
+ * where heap pages go, if no node given for the heap
+ */
+
+typedef enum shmemc_numa {
+    SHMEMC_NUMA_NONE = 0,       /**< first touch decides */
+    SHMEMC_NUMA_LOCAL,          /**< node of CPU running shmem_init */
+    SHMEMC_NUMA_INTERLEAVE      /**< spread over allowed nodes */
+} shmemc_numa_t;
+
+/*
+ * How PEs learn about each other at start-up
+ */
+
+typedef enum shmemc_bootstrap {
+    SHMEMC_BOOTSTRAP_EAGER = 0, /**< everyone fetches everything */
+    SHMEMC_BOOTSTRAP_LAZY,      /**< fetch on first contact */
+    SHMEMC_BOOTSTRAP_NODE       /**< node leaders fetch and share */
+} shmemc_bootstrap_t;
+
 /*
  * implementations support some environment variables
  */
@@ -84,6 +122,19 @@ typedef struct env_info {
 
     size_t prealloc_contexts;   /**< set up this many at start */
     bool memfatal;              /**< force exit on memory usage error? */
+    bool shared_direct;         /**< load/store to same-node PEs? */
+    shmemc_bootstrap_t bootstrap; /**< how to get peer info */
+    size_t bootstrap_prefetch;  /**< lazy fetch this many PEs at once */
+    bool startup_profile;       /**< show start-up phase timings? */
+    shmemc_numa_t heap_numa;    /**< NUMA placement of heap pages */
+    size_t heap_prefault;       /**< threads to pre-fault heaps, or 0 */
+    size_t heap_grow;           /**< least to grow default heap by, or 0 */
+    bool heap_same_va;          /**< try to put heaps at same VA on all PEs */
+    bool globals_section;       /**< only register SHMEM_SYMMETRIC globals */
+    bool deferred_free;         /**< shmem_free waits for next barrier */
+    bool heap_stats;            /**< report heap usage at finalize? */
+    size_t bounce_size;         /**< registered local pool, or 0 */
+    size_t bounce_max;          /**< stage put sources up to this size */
 } env_info_t;
 
 /*
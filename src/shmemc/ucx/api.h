@@ -34,13 +34,32 @@ void shmemc_ucx_deallocate_eps_table(shmemc_context_h ch);
 
 int shmemc_ucx_context_progress(shmemc_context_h ch);
 void shmemc_ucx_make_eps(shmemc_context_h ch);
+void shmemc_ucx_connect_pe(shmemc_context_h ch, int pe);
+int shmemc_ucx_connected_pes(shmemc_context_h ch);
+const mem_access_t *shmemc_ucx_connect_region(shmemc_context_h ch,
+                                              size_t r, int pe);
 void shmemc_ucx_disconnect_all_eps(shmemc_context_h ch);
 
 ucs_status_t shmemc_ucx_worker_wireup(shmemc_context_h ch);
 
+void shmemc_ucx_amo_handlers_init(shmemc_context_h ch);
+void shmemc_ucx_amo_handlers_finalize(shmemc_context_h ch);
+
+/*
+ * registered local buffer pool
+ */
+
+void shmemc_ucx_bounce_init(void);
+void shmemc_ucx_bounce_finalize(void);
+
 ucs_status_t shmemc_ucx_rkey_pack(ucp_mem_h mh,
                                   void **packed_rkey_p,
                                   size_t *len_p);
 
+void shmemc_ucx_bootstrap_pack(void **blob_p, size_t *len_p);
+void shmemc_ucx_bootstrap_unpack(int pe, const void *blob, size_t len,
+                                 bool copy);
+void shmemc_ucx_peer_table_memory(size_t *private_p, size_t *shared_p);
+
 
 #endif /* ! _SHMEMC_UCX_H */
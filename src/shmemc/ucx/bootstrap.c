@@ -0,0 +1,731 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "thispe.h"
+#include "shmemu.h"
+#include "shmemc.h"
+#include "state.h"
+#include "pmi_client.h"
+#include "ucx/api.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <ucp/api/ucp.h>
+
+/*
+ * Everything a PE needs to tell the others goes into one blob, so
+ * the PMI layer only has to move a single key per PE:
+ *
+ *   header
+ *   worker address              (header.worker_len bytes)
+ *   per region:
+ *     region header
+ *     packed rkey               (region.rkey_len bytes)
+ *
+ * Fields are copied in and out with memcpy(), so nothing needs to be
+ * aligned.  All PEs run the same library, so no byte-swapping.
+ */
+
+#define BOOTSTRAP_MAGIC   0x4f534258U /* "OSBX" */
+#define BOOTSTRAP_VERSION 1U
+
+typedef struct bootstrap_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nregions;
+    uint32_t worker_len;
+} bootstrap_header_t;
+
+typedef struct bootstrap_region {
+    uint64_t base;
+    uint64_t len;
+    uint32_t rkey_len;
+} bootstrap_region_t;
+
+void
+shmemc_ucx_bootstrap_pack(void **blob_p, size_t *len_p)
+{
+    const worker_info_t *wp = & proc.comms.xchg_wrkr_info[proc.rank];
+    void **rkeys;
+    size_t *rkey_lens;
+    bootstrap_header_t h;
+    char *blob;
+    char *cp;
+    size_t len;
+    size_t r;
+
+    rkeys = (void **) malloc(proc.comms.nregions * sizeof(*rkeys));
+    rkey_lens = (size_t *) malloc(proc.comms.nregions * sizeof(*rkey_lens));
+    shmemu_assert((rkeys != NULL) && (rkey_lens != NULL),
+                  "can't allocate memory to pack bootstrap info");
+
+    len = sizeof(h) + wp->len;
+
+    for (r = 0; r < proc.comms.nregions; ++r) {
+        const ucs_status_t s =
+            shmemc_ucx_rkey_pack(proc.comms.regions[r].minfo[proc.rank].mh,
+                                 &rkeys[r], &rkey_lens[r]
+                                 );
+        shmemu_assert(s == UCS_OK,
+                      "can't pack rkey for memory region %lu",
+                      (unsigned long) r);
+
+        len += sizeof(bootstrap_region_t) + rkey_lens[r];
+    }
+
+    blob = (char *) malloc(len);
+    shmemu_assert(blob != NULL,
+                  "can't allocate memory for bootstrap blob");
+
+    h.magic      = BOOTSTRAP_MAGIC;
+    h.version    = BOOTSTRAP_VERSION;
+    h.nregions   = (uint32_t) proc.comms.nregions;
+    h.worker_len = (uint32_t) wp->len;
+
+    cp = blob;
+    memcpy(cp, &h, sizeof(h));
+    cp += sizeof(h);
+    memcpy(cp, wp->addr, wp->len);
+    cp += wp->len;
+
+    for (r = 0; r < proc.comms.nregions; ++r) {
+        const mem_info_t *mip = & proc.comms.regions[r].minfo[proc.rank];
+        bootstrap_region_t br;
+
+        br.base     = mip->base;
+        br.len      = mip->len;
+        br.rkey_len = (uint32_t) rkey_lens[r];
+
+        memcpy(cp, &br, sizeof(br));
+        cp += sizeof(br);
+        memcpy(cp, rkeys[r], rkey_lens[r]);
+        cp += rkey_lens[r];
+
+        ucp_rkey_buffer_release(rkeys[r]);
+    }
+
+    free(rkey_lens);
+    free(rkeys);
+
+    *blob_p = blob;
+    *len_p = len;
+}
+
+/*
+ * where each region's info sits in a blob (or segment)
+ */
+typedef struct blob_region {
+    uint64_t base;
+    uint64_t len;
+    const char *rkey;
+    size_t rkey_len;
+} blob_region_t;
+
+/*
+ * how much memory the worker and rkey tables use in this PE
+ */
+static size_t private_bytes = 0;
+
+/*
+ * copy out of the blob, with bounds check
+ */
+inline static const char *
+take(void *dest, const char *cp, size_t n, const char *end, int pe)
+{
+    shmemu_assert(cp + n <= end,
+                  "bootstrap blob from PE %d is truncated",
+                  pe);
+
+    memcpy(dest, cp, n);
+
+    return cp + n;
+}
+
+/*
+ * find the worker and per-region info in PE's blob, without copying
+ */
+static void
+parse_blob(int pe, const void *blob, size_t len,
+           const char **worker_p, size_t *worker_len_p,
+           blob_region_t *brp)
+{
+    const char *cp = (const char *) blob;
+    const char *end = cp + len;
+    bootstrap_header_t h;
+    size_t r;
+
+    cp = take(&h, cp, sizeof(h), end, pe);
+
+    shmemu_assert(h.magic == BOOTSTRAP_MAGIC,
+                  "bootstrap blob from PE %d is corrupt",
+                  pe);
+    shmemu_assert(h.version == BOOTSTRAP_VERSION,
+                  "bootstrap blob from PE %d is version %u, expected %u",
+                  pe, (unsigned) h.version, BOOTSTRAP_VERSION);
+    shmemu_assert(h.nregions == proc.comms.nregions,
+                  "PE %d has %u memory regions, expected %lu",
+                  pe, (unsigned) h.nregions,
+                  (unsigned long) proc.comms.nregions);
+    shmemu_assert(cp + h.worker_len <= end,
+                  "bootstrap blob from PE %d is truncated",
+                  pe);
+
+    *worker_p = cp;
+    *worker_len_p = h.worker_len;
+    cp += h.worker_len;
+
+    for (r = 0; r < proc.comms.nregions; ++r) {
+        bootstrap_region_t br;
+
+        cp = take(&br, cp, sizeof(br), end, pe);
+        shmemu_assert(cp + br.rkey_len <= end,
+                      "bootstrap blob from PE %d is truncated",
+                      pe);
+
+        brp[r].base     = br.base;
+        brp[r].len      = br.len;
+        brp[r].rkey     = cp;
+        brp[r].rkey_len = br.rkey_len;
+
+        cp += br.rkey_len;
+    }
+}
+
+inline static void *
+dup_bytes(const char *src, size_t n, int pe)
+{
+    void *dest = malloc(n);
+
+    shmemu_assert(dest != NULL,
+                  "can't allocate memory for bootstrap info from PE %d",
+                  pe);
+    memcpy(dest, src, n);
+
+    private_bytes += n;
+
+    return dest;
+}
+
+/*
+ * record PE's info in proc.comms.  If "copy" is false, the worker and
+ * rkeys are left where they are, which then has to outlive them.
+ */
+static void
+set_peer_info(int pe,
+              const char *worker, size_t worker_len,
+              const blob_region_t *brp,
+              bool copy)
+{
+    size_t r;
+
+    proc.comms.xchg_wrkr_info[pe].buf =
+        copy ? (char *) dup_bytes(worker, worker_len, pe) : (char *) worker;
+
+    for (r = 0; r < proc.comms.nregions; ++r) {
+        proc.comms.orks[r].rkeys[pe].data =
+            copy ? dup_bytes(brp[r].rkey, brp[r].rkey_len, pe)
+            : (void *) brp[r].rkey;
+
+#ifndef ENABLE_ALIGNED_ADDRESSES
+        /* globals always line up, and we already know our own */
+        if ((r > 0) && (pe != proc.rank)) {
+            mem_info_t *mip = & proc.comms.regions[r].minfo[pe];
+
+            mip->base = brp[r].base;
+            mip->len  = brp[r].len;
+            /* slightly redundant storage, but useful */
+            mip->end  = brp[r].base + brp[r].len;
+        }
+#endif /* ! ENABLE_ALIGNED_ADDRESSES */
+    }
+}
+
+/*
+ * decode PE's blob into proc.comms
+ */
+
+void
+shmemc_ucx_bootstrap_unpack(int pe, const void *blob, size_t len,
+                            bool copy)
+{
+    blob_region_t *brp;
+    const char *worker;
+    size_t worker_len;
+
+    brp = (blob_region_t *) malloc(proc.comms.nregions * sizeof(*brp));
+    shmemu_assert(brp != NULL,
+                  "can't allocate memory to unpack bootstrap info");
+
+    parse_blob(pe, blob, len, &worker, &worker_len, brp);
+    set_peer_info(pe, worker, worker_len, brp, copy);
+
+    free(brp);
+}
+
+/* -------------------------------------------------------------- */
+
+/*
+ * Eager bootstrap: fetch everyone's blob now
+ */
+
+void
+shmemc_pmi_exchange_peer(int pe)
+{
+    size_t len;
+    void *blob = shmemc_pmi_fetch_bootstrap(pe, &len);
+
+    shmemc_ucx_bootstrap_unpack(pe, blob, len, true);
+
+    free(blob);
+}
+
+void
+shmemc_pmi_exchange_bootstrap(void)
+{
+    int pe;
+
+    for (pe = 0; pe < proc.nranks; ++pe) {
+        shmemc_pmi_exchange_peer(shmemu_shift(pe));
+    }
+}
+
+/* -------------------------------------------------------------- */
+
+/*
+ * Lazy bootstrap: nothing is fetched at start-up.  The first time a
+ * PE is contacted we pull its blob, along with those of the rest of
+ * its prefetch batch.
+ */
+
+static bool *fetched = NULL;    /* NULL if everything fetched eagerly */
+static int fetch_lock = 0;
+
+void
+shmemc_pmi_fetch_init(void)
+{
+    fetched = (bool *) calloc(proc.nranks, sizeof(*fetched));
+    shmemu_assert(fetched != NULL,
+                  "can't allocate memory for lazy peer info fetch");
+}
+
+void
+shmemc_pmi_fetch_finalize(void)
+{
+    int n = 0;
+    int pe;
+
+    if (fetched == NULL) {
+        return;
+        /* NOT REACHED */
+    }
+
+    for (pe = 0; pe < proc.nranks; ++pe) {
+        if (fetched[pe]) {
+            ++n;
+        }
+    }
+
+    logger(LOG_FINALIZE,
+           "fetched peer info for %d of %d PEs",
+           n, proc.nranks);
+
+    free(fetched);
+    fetched = NULL;
+}
+
+void
+shmemc_pmi_fetch_peer(int pe)
+{
+    const int batch = (int) proc.env.bootstrap_prefetch;
+    int first, last;
+    int i;
+
+    if (fetched == NULL) {
+        return;
+        /* NOT REACHED */
+    }
+
+    if (__atomic_load_n(& fetched[pe], __ATOMIC_ACQUIRE)) {
+        return;
+        /* NOT REACHED */
+    }
+
+    /* PMI calls and key buffers aren't safe to share */
+    while (__atomic_exchange_n(& fetch_lock, 1, __ATOMIC_ACQUIRE)) {
+        /* spin */ ;
+    }
+
+    first = (batch > 1) ? (pe / batch) * batch : pe;
+    last  = (batch > 1) ? first + batch : pe + 1;
+    if (last > proc.nranks) {
+        last = proc.nranks;
+    }
+
+    for (i = first; i < last; ++i) {
+        if (! fetched[i]) {
+            shmemc_pmi_exchange_peer(i);
+            __atomic_store_n(& fetched[i], true, __ATOMIC_RELEASE);
+        }
+    }
+
+    __atomic_store_n(& fetch_lock, 0, __ATOMIC_RELEASE);
+}
+
+/* -------------------------------------------------------------- */
+
+/*
+ * Node bootstrap: only the first PE on each node (the leader) talks
+ * to PMI about the rest of the job.  It gathers every PE's worker
+ * address and rkeys into a node-local shared memory segment:
+ *
+ *   header
+ *   per PE: 1 record for the worker, then 1 per region
+ *   data
+ *
+ * Records give the offset and length of their bytes in the data
+ * area, and identical byte strings are only stored once.  Peers map
+ * the segment read-only and the worker and rkey tables point
+ * straight into it, so there's one copy per node.
+ */
+
+#define NODE_SEGMENT_MAGIC 0x4f534e54U /* "OSNT" */
+
+typedef struct node_record {
+    uint64_t off;               /* from start of segment */
+    uint64_t len;
+    uint64_t base;              /* regions only */
+    uint64_t extent;
+} node_record_t;
+
+typedef struct node_segment {
+    uint32_t magic;
+    uint32_t nranks;
+    uint32_t nregions;
+    uint32_t unused;
+    node_record_t records[];
+} node_segment_t;
+
+#define RECORDS_PER_PE (1 + proc.comms.nregions)
+
+static node_segment_t *segment = NULL;
+static size_t segment_len = 0;
+static char segment_name[NAME_MAX];
+
+inline static void
+segment_name_init(void)
+{
+    char *p;
+
+    /* job & leader rank are the same for everyone on the node */
+    snprintf(segment_name, sizeof(segment_name),
+             "/shmem-boot-%s-%d",
+             shmemc_pmi_job_name(), proc.peers[0]);
+
+    /* only the leading "/" allowed */
+    for (p = segment_name + 1; *p != '\0'; ++p) {
+        if (*p == '/') {
+            *p = '_';
+        }
+    }
+}
+
+/*
+ * Remember distinct byte strings while the leader builds the segment
+ * (open addressing, table size a power of 2)
+ */
+
+typedef struct dedup_entry {
+    const char *src;            /* NULL if slot empty */
+    size_t len;
+    uint64_t off;
+} dedup_entry_t;
+
+typedef struct dedup_table {
+    dedup_entry_t *slots;
+    size_t mask;
+    uint64_t next_off;          /* where next new string goes */
+    size_t saved;               /* bytes not stored twice */
+} dedup_table_t;
+
+inline static uint64_t
+fnv1a(const char *p, size_t n)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        h ^= (unsigned char) p[i];
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+static uint64_t
+dedup_insert(dedup_table_t *dtp, const char *src, size_t len)
+{
+    size_t i = fnv1a(src, len) & dtp->mask;
+
+    for (;;) {
+        dedup_entry_t *ep = & dtp->slots[i];
+
+        if (ep->src == NULL) {
+            ep->src = src;
+            ep->len = len;
+            ep->off = dtp->next_off;
+            dtp->next_off += len;
+            return ep->off;
+            /* NOT REACHED */
+        }
+        if ((ep->len == len) && (memcmp(ep->src, src, len) == 0)) {
+            dtp->saved += len;
+            return ep->off;
+            /* NOT REACHED */
+        }
+
+        i = (i + 1) & dtp->mask;
+    }
+}
+
+inline static void
+segment_create(void)
+{
+    const size_t nrecs = proc.nranks * RECORDS_PER_PE;
+    void **blobs;
+    node_record_t *recs;
+    blob_region_t *brp;
+    dedup_table_t dt;
+    size_t hdr;
+    size_t nslots;
+    size_t i;
+    int fd;
+    int pe;
+
+    blobs = (void **) malloc(proc.nranks * sizeof(*blobs));
+    recs = (node_record_t *) malloc(nrecs * sizeof(*recs));
+    brp = (blob_region_t *) malloc(proc.comms.nregions * sizeof(*brp));
+    shmemu_assert((blobs != NULL) && (recs != NULL) && (brp != NULL),
+                  "can't allocate memory for node bootstrap");
+
+    for (nslots = 1; nslots < 2 * nrecs; nslots <<= 1) {
+        /* power of 2 with room to spare */ ;
+    }
+    dt.slots = (dedup_entry_t *) calloc(nslots, sizeof(*dt.slots));
+    shmemu_assert(dt.slots != NULL,
+                  "can't allocate memory for node bootstrap");
+    dt.mask = nslots - 1;
+    dt.saved = 0;
+
+    hdr = sizeof(node_segment_t) + nrecs * sizeof(node_record_t);
+    dt.next_off = hdr;
+
+    /* lay out the segment */
+    for (pe = 0; pe < proc.nranks; ++pe) {
+        node_record_t *rp = & recs[pe * RECORDS_PER_PE];
+        const char *worker;
+        size_t worker_len;
+        size_t blen;
+        size_t r;
+
+        blobs[pe] = shmemc_pmi_fetch_bootstrap(pe, &blen);
+        parse_blob(pe, blobs[pe], blen, &worker, &worker_len, brp);
+
+        rp->off = dedup_insert(&dt, worker, worker_len);
+        rp->len = worker_len;
+        rp->base = rp->extent = 0;
+
+        for (r = 0; r < proc.comms.nregions; ++r) {
+            ++rp;
+            rp->off = dedup_insert(&dt, brp[r].rkey, brp[r].rkey_len);
+            rp->len = brp[r].rkey_len;
+            rp->base = brp[r].base;
+            rp->extent = brp[r].len;
+        }
+    }
+
+    segment_len = dt.next_off;
+
+    fd = shm_open(segment_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    shmemu_assert(fd >= 0,
+                  "can't create node bootstrap segment \"%s\": %s",
+                  segment_name, strerror(errno));
+    shmemu_assert(ftruncate(fd, segment_len) == 0,
+                  "can't size node bootstrap segment: %s",
+                  strerror(errno));
+
+    segment = (node_segment_t *) mmap(NULL, segment_len,
+                                      PROT_READ | PROT_WRITE, MAP_SHARED,
+                                      fd, 0);
+    shmemu_assert(segment != MAP_FAILED,
+                  "can't map node bootstrap segment: %s",
+                  strerror(errno));
+    close(fd);
+
+    segment->magic = NODE_SEGMENT_MAGIC;
+    segment->nranks = (uint32_t) proc.nranks;
+    segment->nregions = (uint32_t) proc.comms.nregions;
+    segment->unused = 0;
+    memcpy(segment->records, recs, nrecs * sizeof(*recs));
+
+    for (i = 0; i < nslots; ++i) {
+        const dedup_entry_t *ep = & dt.slots[i];
+
+        if (ep->src != NULL) {
+            memcpy((char *) segment + ep->off, ep->src, ep->len);
+        }
+    }
+
+    logger(LOG_INIT,
+           "node bootstrap segment \"%s\" is %lu bytes"
+           " (%lu duplicate bytes not stored)",
+           segment_name,
+           (unsigned long) segment_len,
+           (unsigned long) dt.saved);
+
+    for (pe = 0; pe < proc.nranks; ++pe) {
+        free(blobs[pe]);
+    }
+    free(dt.slots);
+    free(brp);
+    free(recs);
+    free(blobs);
+}
+
+inline static void
+segment_attach(void)
+{
+    struct stat sb;
+    int fd;
+
+    fd = shm_open(segment_name, O_RDONLY, 0);
+    shmemu_assert(fd >= 0,
+                  "can't open node bootstrap segment \"%s\": %s",
+                  segment_name, strerror(errno));
+    shmemu_assert(fstat(fd, &sb) == 0,
+                  "can't size node bootstrap segment: %s",
+                  strerror(errno));
+
+    segment_len = (size_t) sb.st_size;
+
+    segment = (node_segment_t *) mmap(NULL, segment_len,
+                                      PROT_READ, MAP_SHARED,
+                                      fd, 0);
+    shmemu_assert(segment != MAP_FAILED,
+                  "can't map node bootstrap segment: %s",
+                  strerror(errno));
+    close(fd);
+
+    shmemu_assert(segment->magic == NODE_SEGMENT_MAGIC,
+                  "node bootstrap segment \"%s\" is corrupt",
+                  segment_name);
+    shmemu_assert(segment->nranks == (uint32_t) proc.nranks,
+                  "node bootstrap segment has %u PEs, expected %d",
+                  (unsigned) segment->nranks, proc.nranks);
+    shmemu_assert(segment->nregions == (uint32_t) proc.comms.nregions,
+                  "node bootstrap segment has %u memory regions,"
+                  " expected %lu",
+                  (unsigned) segment->nregions,
+                  (unsigned long) proc.comms.nregions);
+}
+
+void
+shmemc_pmi_node_exchange(void)
+{
+    blob_region_t *brp;
+    int pe;
+
+    segment_name_init();
+
+    if (proc.leader) {
+        segment_create();
+    }
+
+    /* wait for leaders to fill their segments */
+    shmemc_pmi_barrier_all(false);
+
+    if (! proc.leader) {
+        segment_attach();
+    }
+
+    brp = (blob_region_t *) malloc(proc.comms.nregions * sizeof(*brp));
+    shmemu_assert(brp != NULL,
+                  "can't allocate memory for node bootstrap");
+
+    for (pe = 0; pe < proc.nranks; ++pe) {
+        const node_record_t *rp = & segment->records[pe * RECORDS_PER_PE];
+        const char *base = (const char *) segment;
+        size_t r;
+
+        for (r = 0; r < proc.comms.nregions; ++r) {
+            const node_record_t *rrp = & rp[1 + r];
+
+            brp[r].base     = rrp->base;
+            brp[r].len      = rrp->extent;
+            brp[r].rkey     = base + rrp->off;
+            brp[r].rkey_len = rrp->len;
+        }
+
+        set_peer_info(pe, base + rp->off, rp->len, brp, false);
+    }
+
+    free(brp);
+
+    proc.comms.boot_shared = true;
+}
+
+/*
+ * once all peers have it mapped, the name can go
+ */
+
+void
+shmemc_pmi_node_release(void)
+{
+    if (proc.leader) {
+        (void) shm_unlink(segment_name);
+    }
+}
+
+void
+shmemc_pmi_node_finalize(void)
+{
+    if (segment == NULL) {
+        return;
+        /* NOT REACHED */
+    }
+
+    logger(LOG_FINALIZE,
+           "node bootstrap segment was %lu bytes",
+           (unsigned long) segment_len);
+
+    (void) munmap(segment, segment_len);
+    segment = NULL;
+}
+
+/* -------------------------------------------------------------- */
+
+/*
+ * memory used by the worker and rkey tables: "private" is in this
+ * PE, "shared" is the node segment, shared by all PEs on the node
+ */
+
+void
+shmemc_ucx_peer_table_memory(size_t *private_p, size_t *shared_p)
+{
+    *private_p =
+        proc.nranks * sizeof(worker_info_t) +
+        proc.comms.nregions * proc.nranks * sizeof(mem_opaque_rkey_t) +
+        private_bytes;
+    *shared_p = segment_len;
+}
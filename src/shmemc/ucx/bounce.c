@@ -0,0 +1,157 @@
+/* For license: see LICENSE file at top-level */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include "thispe.h"
+#include "shmemu.h"
+#include "shmemc.h"
+#include "state.h"
+#include "api.h"
+
+#include "allocator/internal-malloc.h"
+
+#include <ucp/api/ucp.h>
+
+/*
+ * A pool of local memory registered once at start-up.  Puts stage
+ * unregistered sources through it (see comms.c), and programs can
+ * allocate from it to build send buffers UCX already knows about.
+ */
+
+static mspace bounce_space;
+
+/*
+ * puts allocate on the calling thread, but completion callbacks free
+ * on whichever thread progresses the worker (e.g. a progress thread)
+ */
+static int bounce_lock = 0;
+
+inline static void
+pool_lock(void)
+{
+    while (__atomic_exchange_n(& bounce_lock, 1, __ATOMIC_ACQUIRE)) {
+        /* spin */ ;
+    }
+}
+
+inline static void
+pool_unlock(void)
+{
+    __atomic_store_n(& bounce_lock, 0, __ATOMIC_RELEASE);
+}
+
+void
+shmemc_ucx_bounce_init(void)
+{
+    mem_info_t *bp = & proc.comms.bounce;
+    ucp_mem_map_params_t mp;
+    ucp_mem_attr_t attr;
+    ucs_status_t s;
+
+    bp->len = 0;
+
+    if (proc.env.bounce_size == 0) {
+        return;
+        /* NOT REACHED */
+    }
+
+    mp.field_mask =
+        UCP_MEM_MAP_PARAM_FIELD_LENGTH |
+        UCP_MEM_MAP_PARAM_FIELD_FLAGS;
+    mp.length = proc.env.bounce_size;
+    mp.flags = UCP_MEM_MAP_ALLOCATE;
+
+    s = ucp_mem_map(proc.comms.ucx_ctxt, &mp, &bp->mh);
+    if (s != UCS_OK) {
+        shmemu_warn("can't map %lu bytes for bounce buffers: %s",
+                    (unsigned long) proc.env.bounce_size,
+                    ucs_status_string(s));
+        return;
+        /* NOT REACHED */
+    }
+
+    attr.field_mask =
+        UCP_MEM_ATTR_FIELD_ADDRESS |
+        UCP_MEM_ATTR_FIELD_LENGTH;
+
+    s = ucp_mem_query(bp->mh, &attr);
+    shmemu_assert(s == UCS_OK,
+                  "can't query extent of bounce buffers: %s",
+                  ucs_status_string(s));
+
+    bounce_space = create_mspace_with_base(attr.address, attr.length, 0);
+    if (bounce_space == NULL) {
+        shmemu_warn("can't manage bounce buffers");
+        (void) ucp_mem_unmap(proc.comms.ucx_ctxt, bp->mh);
+        return;
+        /* NOT REACHED */
+    }
+
+    bp->base = (uint64_t) attr.address;
+    bp->end  = bp->base + attr.length;
+    bp->len  = attr.length;
+
+    logger(LOG_MEMORY,
+           "bounce buffers: %lu bytes @ %p",
+           (unsigned long) bp->len, attr.address);
+}
+
+void
+shmemc_ucx_bounce_finalize(void)
+{
+    mem_info_t *bp = & proc.comms.bounce;
+    ucs_status_t s;
+
+    if (bp->len == 0) {
+        return;
+        /* NOT REACHED */
+    }
+
+    destroy_mspace(bounce_space);
+    bounce_space = NULL;
+
+    s = ucp_mem_unmap(proc.comms.ucx_ctxt, bp->mh);
+    shmemu_assert(s == UCS_OK,
+                  "can't unmap bounce buffers: %s",
+                  ucs_status_string(s));
+
+    bp->len = 0;
+}
+
+/*
+ * NULL if there's no pool, or it's full
+ */
+void *
+shmemc_bounce_alloc(size_t n)
+{
+    void *p;
+
+    if (proc.comms.bounce.len == 0) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    pool_lock();
+    p = mspace_malloc(bounce_space, n);
+    pool_unlock();
+
+    return p;
+}
+
+void
+shmemc_bounce_free(void *p)
+{
+    if (p == NULL) {
+        return;
+        /* NOT REACHED */
+    }
+
+    shmemu_assert(proc.comms.bounce.len > 0,
+                  "no bounce buffers to free %p into", p);
+
+    pool_lock();
+    mspace_free(bounce_space, p);
+    pool_unlock();
+}
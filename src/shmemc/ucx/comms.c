@@ -7,10 +7,14 @@
 #include "shmemu.h"
 #include "shmemc.h"
 #include "state.h"
+#include "memfence.h"
+#include "api.h"
+#include "pmi_client.h"
 
 #include "shmem/defs.h"
 
 #include <unistd.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <ucp/api/ucp.h>
@@ -20,21 +24,65 @@
  */
 
 /*
- * shortcut to look up the UCP endpoint of a context
+ * endpoints and rkeys are only set up when a PE is first used
+ */
+inline static void
+ensure_connected(shmemc_context_h ch, int pe)
+{
+    if (shmemu_unlikely(__atomic_load_n(& ch->eps[pe],
+                                        __ATOMIC_ACQUIRE) == NULL)) {
+        shmemc_ucx_connect_pe(ch, pe);
+    }
+}
+
+/*
+ * shortcut to look up the UCP endpoint of a context.  We're about to
+ * send something on it, so quiet will have to flush it.
  */
 inline static ucp_ep_h
 lookup_ucp_ep(shmemc_context_h ch, int pe)
 {
+    ep_dirty_set_t *dsp = & ch->dirty;
+
+    ensure_connected(ch, pe);
+
+    if (dsp->enabled && ! dsp->flags[pe]) {
+        dsp->flags[pe] = true;
+        dsp->pes[dsp->npes++] = pe;
+    }
+
     return ch->eps[pe];
 }
 
+/*
+ * find remote access info for memory "region" on PE "pe".  Regions
+ * added when the heap grew are unpacked the first time they're used.
+ */
+inline static const mem_access_t *
+lookup_access(shmemc_context_h ch, size_t region, int pe)
+{
+    const mem_access_t *rinfo;
+
+    ensure_connected(ch, pe);
+
+    rinfo = __atomic_load_n(& ch->racc[region].rinfo, __ATOMIC_ACQUIRE);
+    if (shmemu_unlikely((rinfo == NULL) ||
+                        (__atomic_load_n(& rinfo[pe].rkey,
+                                         __ATOMIC_ACQUIRE) == NULL))) {
+        return shmemc_ucx_connect_region(ch, region, pe);
+        /* NOT REACHED */
+    }
+
+    return & rinfo[pe];
+}
+
 /*
  * find rkey for memory "region" on PE "pe"
  */
 inline static ucp_rkey_h
 lookup_rkey(shmemc_context_h ch, size_t region, int pe)
 {
-    return ch->racc[region].rinfo[pe].rkey;
+    return lookup_access(ch, region, pe)->rkey;
 }
 
 /*
@@ -55,20 +103,31 @@ in_region(uint64_t addr, size_t region)
 
 /*
  * find memory region that ADDR is in, or -1 if none
+ *
+ * Binary search of the region index, which is kept sorted by local
+ * base address.  The heap can grow under us, so take whichever index
+ * is current and stick with it.
  */
 inline static long
 lookup_region(uint64_t addr)
 {
-    long r;
+    const mem_region_table_t *rtp =
+        __atomic_load_n(& proc.comms.rtable, __ATOMIC_ACQUIRE);
+    const mem_region_index_t *rip = rtp->index;
+    size_t lo = 0;
+    size_t hi = rtp->nregions;
 
-    /*
-     * Let's search down from top heap to globals (#0) under
-     * assumption most data in heaps and newest one is most likely
-     * (may need to revisit)
-     */
-    for (r = proc.comms.nregions - 1; r >= 0; --r) {
-        if (in_region(addr, (size_t) r)) {
-            return r;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        if (addr < rip[mid].base) {
+            hi = mid;
+        }
+        else if (addr >= rip[mid].end) {
+            lo = mid + 1;
+        }
+        else {
+            return rip[mid].region;
             /* NOT REACHED */
         }
     }
@@ -76,13 +135,36 @@ lookup_region(uint64_t addr)
     return -1L;
 }
 
+/*
+ * as above, but try the region this context hit last time first:
+ * programs tend to hammer the same heap
+ */
+inline static long
+lookup_ctx_region(shmemc_context_h ch, uint64_t addr)
+{
+    long r = ch->last_region;
+
+    if (shmemu_likely(in_region(addr, (size_t) r))) {
+        return r;
+        /* NOT REACHED */
+    }
+
+    r = lookup_region(addr);
+    if (r >= 0) {
+        ch->last_region = r;
+    }
+
+    return r;
+}
+
 /*
  * translate remote address:
  *
  * if all addresses aligned, remote always == local
  *
- * otherwise globals are always aligned, but translate shmalloc'ed
- * variables
+ * otherwise globals are always aligned, and so are heaps if they
+ * could be put at the same address everywhere at start-up, but
+ * translate other shmalloc'ed variables
  */
 #ifdef ENABLE_ALIGNED_ADDRESSES
 # define translate_region_address(_local_addr, _region, _pe) (_local_addr)
@@ -97,7 +179,7 @@ lookup_region(uint64_t addr)
 inline static uint64_t
 translate_region_address(uint64_t local_addr, size_t region, int pe)
 {
-    if (region == 0) {
+    if (proc.comms.regions[region].aligned) {
         return local_addr;
     }
     else {
@@ -132,7 +214,7 @@ get_remote_key_and_addr(shmemc_context_h ch,
                         uint64_t local_addr, int pe,
                         ucp_rkey_h *rkey_p, uint64_t *raddr_p)
 {
-    const long r = lookup_region(local_addr);
+    const long r = lookup_ctx_region(ch, local_addr);
 
     shmemu_assert(r >= 0,
                   "can't find memory region for %p",
@@ -143,56 +225,115 @@ get_remote_key_and_addr(shmemc_context_h ch,
 }
 
 /*
- * -- ordering -----------------------------------------------------------
+ * -- direct access to PEs on this node --------------------------------
  */
 
 /*
- * fence and quiet only do something on storable contexts, but
- * currently, progress is on the default context
+ * if PE's memory is mapped into this process, return where the
+ * counterpart of local_addr lives, otherwise NULL
  */
+#ifdef HAVE_UCP_RKEY_PTR
+inline static void *
+lookup_direct_addr(shmemc_context_h ch, uint64_t local_addr, int pe)
+{
+    long r;
+    char *mp;
 
-#define SHMEMC_FENCE_QUIET(_op, _ucp_op)                                \
-    void                                                                \
-    shmemc_ctx_##_op(shmem_ctx_t ctx)                                   \
-    {                                                                   \
-        if (ctx != SHMEM_CTX_INVALID) {                                 \
-            shmemc_context_h ch = (shmemc_context_h) ctx;               \
-                                                                        \
-            if (! ch->attr.nostore) {                                   \
-                const ucs_status_t s = ucp_worker_##_ucp_op(ch->w);     \
-                                                                        \
-                shmemu_assert(s == UCS_OK,                              \
-                              "%s() failed (status: %s)", #_op,         \
-                              ucs_status_string(s));                    \
-            }                                                           \
-        }                                                               \
+    if (shmemu_likely(! proc.env.shared_direct)) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    r = lookup_ctx_region(ch, local_addr);
+    if (r < 0) {
+        return NULL;
+        /* NOT REACHED */
     }
 
-SHMEMC_FENCE_QUIET(fence, fence)
-SHMEMC_FENCE_QUIET(quiet, flush)
+    mp = (char *) lookup_access(ch, r, pe)->mapped;
+    if (mp == NULL) {
+        return NULL;
+        /* NOT REACHED */
+    }
 
-#ifdef ENABLE_EXPERIMENTAL
+    return mp + (local_addr - proc.comms.regions[r].minfo[proc.rank].base);
+}
+#else
+# define lookup_direct_addr(_ch, _local_addr, _pe) NULL
+#endif  /* HAVE_UCP_RKEY_PTR */
 
 /*
- * This should be correct, but not optimal.  Gets us going.
+ * AMOs on mapped memory: "_builtin" is the (C11-model) atomic to
+ * apply at the right width
  */
+#define DIRECT_FETCH_AMO(_builtin, _dp, _vp, _vs, _retp)                \
+    do {                                                                \
+        if ((_vs) == sizeof(uint64_t)) {                                \
+            *(uint64_t *) (_retp) =                                     \
+                _builtin((uint64_t *) (_dp), *(uint64_t *) (_vp),       \
+                         __ATOMIC_SEQ_CST);                             \
+        }                                                               \
+        else {                                                          \
+            *(uint32_t *) (_retp) =                                     \
+                _builtin((uint32_t *) (_dp), *(uint32_t *) (_vp),       \
+                         __ATOMIC_SEQ_CST);                             \
+        }                                                               \
+    } while (0)
 
-int
-shmemc_ctx_fence_test(shmem_ctx_t ctx)
+#define DIRECT_CSWAP_AMO(_dp, _cp, _vs, _retp)                          \
+    do {                                                                \
+        if ((_vs) == sizeof(uint64_t)) {                                \
+            uint64_t _old = *(uint64_t *) (_cp);                        \
+                                                                        \
+            (void) __atomic_compare_exchange_n((uint64_t *) (_dp),      \
+                                               &_old,                   \
+                                               *(uint64_t *) (_retp),   \
+                                               false,                   \
+                                               __ATOMIC_SEQ_CST,        \
+                                               __ATOMIC_SEQ_CST);       \
+            *(uint64_t *) (_retp) = _old;                               \
+        }                                                               \
+        else {                                                          \
+            uint32_t _old = *(uint32_t *) (_cp);                        \
+                                                                        \
+            (void) __atomic_compare_exchange_n((uint32_t *) (_dp),      \
+                                               &_old,                   \
+                                               *(uint32_t *) (_retp),   \
+                                               false,                   \
+                                               __ATOMIC_SEQ_CST,        \
+                                               __ATOMIC_SEQ_CST);       \
+            *(uint32_t *) (_retp) = _old;                               \
+        }                                                               \
+    } while (0)
+
+/*
+ * -- ordering -----------------------------------------------------------
+ */
+
+/*
+ * signals queued behind an endpoint flush have to be sent before we
+ * can claim ordering or completion (see put_signal below)
+ */
+inline static void
+wait_pending_signals(shmemc_context_h ch)
 {
-    shmemc_ctx_fence(ctx);
-    return 1;
+    while (__atomic_load_n(& ch->nsignals, __ATOMIC_ACQUIRE) > 0) {
+        (void) ucp_worker_progress(ch->w);
+    }
 }
 
-int
-shmemc_ctx_quiet_test(shmem_ctx_t ctx)
+/*
+ * non-blocking fetches have to deliver their values by quiet (see
+ * helper_fetching_amo_nbi below)
+ */
+inline static void
+wait_pending_fetches(shmemc_context_h ch)
 {
-    shmemc_ctx_quiet(ctx);
-    return 1;
+    while (__atomic_load_n(& ch->nfetches, __ATOMIC_ACQUIRE) > 0) {
+        (void) ucp_worker_progress(ch->w);
+    }
 }
 
-#endif  /* ENABLE_EXPERIMENTAL */
-
 void
 nb_callback(void *req, ucs_status_t status)
 {
@@ -237,263 +378,1263 @@ check_wait_for_request(shmemc_context_h ch, void *req)
     }
 }
 
-static ucs_status_t
-helper_posted_amo(shmemc_context_h ch,
-                  ucp_atomic_post_op_t uapo,
-                  void *t, void *vp, size_t vs,
-                  int pe)
-{
-    uint64_t r_t;
-    ucp_rkey_h r_key;
-    ucp_ep_h ep;
-    uint64_t rv = *(uint64_t *) vp;
-
-    get_remote_key_and_addr(ch, (uint64_t) t, pe, &r_key, &r_t);
-    ep = lookup_ucp_ep(ch, pe);
-
-    return ucp_atomic_post(ep, uapo, rv, vs, r_t, r_key);
-}
-
 /*
- * fetching AMOs: target t, (optional) condition c, value v
+ * -- put coalescing -----------------------------------------------------
+ *
+ * Contexts created with SHMEMX_CTX_COALESCE buffer small puts per
+ * target PE, as long as each put carries on where the last one
+ * stopped.  A run goes out as one put when it breaks, fills the
+ * buffer, or at fence/quiet/session end.
  */
 
-static ucs_status_t
-helper_fetching_amo(shmemc_context_h ch,
-                    ucp_atomic_fetch_op_t op,
-                    void *t, void *vp, size_t vs,
-                    int pe,
-                    void *retp)
+/* puts bigger than this aren't buffered */
+#define COALESCE_MAX_PUT 256
+
+/* size of per-PE buffer */
+#define COALESCE_BUF_BYTES 4096
+
+static void
+combine_send(shmemc_context_h ch, int pe)
 {
+    put_combine_t *pcp = & ch->combine[pe];
+    uint64_t r_dest;
     ucp_rkey_h r_key;
-    uint64_t r_t;
     ucp_ep_h ep;
-    uint64_t rv = *(uint64_t *) vp;
+#ifdef HAVE_UCP_PUT_NB
     ucs_status_ptr_t sp;
+#endif /* HAVE_UCP_PUT_NB */
+    ucs_status_t s;
 
-    get_remote_key_and_addr(ch, (uint64_t) t, pe, &r_key, &r_t);
+    if (pcp->nbytes == 0) {
+        return;
+        /* NOT REACHED */
+    }
+
+    get_remote_key_and_addr(ch, (uint64_t) pcp->dest, pe, &r_key, &r_dest);
     ep = lookup_ucp_ep(ch, pe);
 
-    sp = ucp_atomic_fetch_nb(ep,
-                             op,
-                             rv, retp, vs,
-                             r_t, r_key, nb_callback);
+    /* buffer is re-used straight away, so need local completion */
+#ifdef HAVE_UCP_PUT_NB
+    sp = ucp_put_nb(ep, pcp->buf, pcp->nbytes, r_dest, r_key,
+                    nb_callback);
+    s = check_wait_for_request(ch, sp);
+#else
+    s = ucp_put(ep, pcp->buf, pcp->nbytes, r_dest, r_key);
+#endif /* HAVE_UCP_PUT_NB */
 
-    return check_wait_for_request(ch, sp);
+    shmemu_assert(s == UCS_OK,
+                  "coalesced put of %lu bytes to PE %d failed (status: %s)",
+                  (unsigned long) pcp->nbytes, pe, ucs_status_string(s));
+
+    pcp->nbytes = 0;
 }
 
-/**
- * API
- *
- **/
+static void
+combine_send_all(shmemc_context_h ch)
+{
+    int i;
+
+    for (i = 0; i < ch->ncombine; ++i) {
+        const int pe = ch->combine_pes[i];
+
+        combine_send(ch, pe);
+        ch->combine[pe].listed = false;
+    }
+    ch->ncombine = 0;
+}
 
 /*
- * make progress on a context
+ * Return true if the put was buffered, false if caller has to send it
  */
-
-inline static void
-helper_ctx_progress(shmem_ctx_t ctx)
+static bool
+combine_put(shmemc_context_h ch,
+            void *dest, const void *src,
+            size_t nbytes, int pe)
 {
-    shmemc_context_h ch = (shmemc_context_h) ctx;
+    put_combine_t *pcp;
 
-    (void) ucp_worker_progress(ch->w);
-}
+    if (shmemu_likely(! ch->attr.coalesce)) {
+        return false;
+        /* NOT REACHED */
+    }
 
-void
-shmemc_ctx_progress(shmem_ctx_t ctx)
-{
-    helper_ctx_progress(ctx);
-}
+    pcp = & ch->combine[pe];
 
-void
-shmemc_progress(void)
-{
-    helper_ctx_progress(SHMEM_CTX_DEFAULT);
-}
+    /* keep a bigger put behind what's already buffered */
+    if (nbytes > COALESCE_MAX_PUT) {
+        combine_send(ch, pe);
+        return false;
+        /* NOT REACHED */
+    }
 
-/*
- * -- accessible memory pointers -----------------------------------------
- */
+    if (pcp->buf == NULL) {
+        pcp->buf = (char *) malloc(COALESCE_BUF_BYTES);
+        if (pcp->buf == NULL) {
+            return false;
+            /* NOT REACHED */
+        }
+    }
 
-/*
- * See if addr is reachable using given context.  Return usable
- * address if so, otherwise NULL.
- */
+    /* does this start a new run? */
+    if ((pcp->nbytes > 0) &&
+        (((char *) dest != pcp->dest + pcp->nbytes) ||
+         (pcp->nbytes + nbytes > COALESCE_BUF_BYTES))) {
+        combine_send(ch, pe);
+    }
 
-inline static void *
-ctx_ptr_self_check(const void *addr)
-{
-    /* is it remotely accessible? */
-    if (lookup_region((uint64_t) addr) >= 0) {
-        return (void *) addr;
+    if (pcp->nbytes == 0) {
+        pcp->dest = (char *) dest;
     }
-    else {
-        return NULL;
+    if (! pcp->listed) {
+        ch->combine_pes[ch->ncombine++] = pe;
+        pcp->listed = true;
+    }
+
+    memcpy(pcp->buf + pcp->nbytes, src, nbytes);
+    pcp->nbytes += nbytes;
+
+    if (pcp->nbytes == COALESCE_BUF_BYTES) {
+        combine_send(ch, pe);
     }
+
+    return true;
 }
 
-inline static void *
-ctx_ptr_remote_check(shmem_ctx_t ctx, const void *addr, int pe)
+void
+shmemc_ctx_coalesce_flush(shmem_ctx_t ctx)
 {
     shmemc_context_h ch = (shmemc_context_h) ctx;
-    uint64_t r_addr;            /* address on other PE */
-    ucp_rkey_h r_key;            /* rkey for remote address */
-    void *usable_addr = NULL;
-    ucs_status_t s;
-
-    get_remote_key_and_addr(ch, (uint64_t) addr, pe, &r_key, &r_addr);
 
-    s = ucp_rkey_ptr(r_key, r_addr, &usable_addr);
-    if (s == UCS_OK) {
-        return usable_addr;
-    }
-    else {
-        return NULL;
+    if (ch->attr.coalesce) {
+        combine_send_all(ch);
     }
 }
 
-void *
-shmemc_ctx_ptr(shmem_ctx_t ctx, const void *addr, int pe)
+/*
+ * nothing sent since the last quiet means nothing to order
+ */
+inline static ucs_status_t
+ctx_fence(shmemc_context_h ch)
 {
-    /* self short-circuit */
-    if (shmemu_unlikely(pe == proc.rank)) {
-        return ctx_ptr_self_check(addr);
+    if (ch->dirty.enabled && (ch->dirty.npes == 0)) {
+        return UCS_OK;
         /* NOT REACHED */
     }
 
-    /* if UCX has check routine, do a full test, otherwise give up */
-#ifdef HAVE_UCP_RKEY_PTR
-    return ctx_ptr_remote_check(ctx, addr, pe);
-#else
-    return NULL;
-#endif  /* HAVE_UCP_RKEY_PTR */
+    return ucp_worker_fence(ch->w);
 }
 
 /*
- * Return non-zero if adddress is remotely accessible, 0 otherwise.
- *
+ * flush the endpoints used since the last quiet: start them all, then
+ * wait for them all.  If most PEs were used, the whole worker is
+ * flushed instead.
  */
-int
-shmemc_addr_accessible(const void *addr, int pe)
+static ucs_status_t
+ctx_flush(shmemc_context_h ch)
 {
-    uint64_t uaddr = (uint64_t) addr;
+    ep_dirty_set_t *dsp = & ch->dirty;
+    ucs_status_t s = UCS_OK;
+    int i;
 
-    NO_WARN_UNUSED(pe);         /* if aligned addresses */
+    if (! dsp->enabled) {
+        return ucp_worker_flush(ch->w);
+        /* NOT REACHED */
+    }
 
-    return translate_address(uaddr, pe) > 0;
-}
+    if (dsp->npes > proc.nranks / 2) {
+        s = ucp_worker_flush(ch->w);
+    }
+    else {
+        for (i = 0; i < dsp->npes; ++i) {
+            dsp->reqs[i] = ucp_ep_flush_nb(ch->eps[dsp->pes[i]], 0,
+                                           nb_callback);
+        }
+        for (i = 0; i < dsp->npes; ++i) {
+            const ucs_status_t es = check_wait_for_request(ch, dsp->reqs[i]);
 
-/*
- * Return non-zero if a valid PE #, 0 otherwise.
- *
- * N.B. this function was originally meant to test which ranks were
- * SHMEM in mixed SHMEM/MPI programs.  Here we just check the rank
- * number is valid and assume reachability, although might want to
+            if (es != UCS_OK) {
+                s = es;
+            }
+        }
+    }
+
+    for (i = 0; i < dsp->npes; ++i) {
+        dsp->flags[dsp->pes[i]] = false;
+    }
+
+    logger(LOG_QUIET,
+           "context #%lu: flushed %d endpoint%s",
+           ch->id, dsp->npes, (dsp->npes == 1) ? "" : "s");
+
+    dsp->npes = 0;
+
+    return s;
+}
+
+/*
+ * fence and quiet only do something on storable contexts, but
+ * currently, progress is on the default context
+ */
+
+#define SHMEMC_FENCE_QUIET(_op, _ucp_op, _fetches)                      \
+    void                                                                \
+    shmemc_ctx_##_op(shmem_ctx_t ctx)                                   \
+    {                                                                   \
+        if (ctx != SHMEM_CTX_INVALID) {                                 \
+            shmemc_context_h ch = (shmemc_context_h) ctx;               \
+                                                                        \
+            if (_fetches) {                                             \
+                wait_pending_fetches(ch);                               \
+            }                                                           \
+                                                                        \
+            if (! ch->attr.nostore) {                                   \
+                ucs_status_t s;                                         \
+                                                                        \
+                if (proc.env.shared_direct) {                           \
+                    LOAD_STORE_FENCE();                                 \
+                }                                                       \
+                                                                        \
+                wait_pending_signals(ch);                               \
+                                                                        \
+                if (ch->attr.coalesce) {                                \
+                    combine_send_all(ch);                               \
+                }                                                       \
+                                                                        \
+                s = ctx_##_ucp_op(ch);                                  \
+                                                                        \
+                shmemu_assert(s == UCS_OK,                              \
+                              "%s() failed (status: %s)", #_op,         \
+                              ucs_status_string(s));                    \
+            }                                                           \
+        }                                                               \
+    }
+
+SHMEMC_FENCE_QUIET(fence, fence, false)
+SHMEMC_FENCE_QUIET(quiet, flush, true)
+
+#ifdef ENABLE_EXPERIMENTAL
+
+/*
+ * This should be correct, but not optimal.  Gets us going.
+ */
+
+int
+shmemc_ctx_fence_test(shmem_ctx_t ctx)
+{
+    shmemc_ctx_fence(ctx);
+    return 1;
+}
+
+int
+shmemc_ctx_quiet_test(shmem_ctx_t ctx)
+{
+    shmemc_ctx_quiet(ctx);
+    return 1;
+}
+
+#endif  /* ENABLE_EXPERIMENTAL */
+
+static ucs_status_t
+helper_posted_amo(shmemc_context_h ch,
+                  ucp_atomic_post_op_t uapo,
+                  void *t, void *vp, size_t vs,
+                  int pe)
+{
+    uint64_t r_t;
+    ucp_rkey_h r_key;
+    ucp_ep_h ep;
+    uint64_t rv = *(uint64_t *) vp;
+    void *dp = lookup_direct_addr(ch, (uint64_t) t, pe);
+
+    if (dp != NULL) {
+        uint64_t discard;
+
+        switch (uapo) {
+        case UCP_ATOMIC_POST_OP_ADD:
+            DIRECT_FETCH_AMO(__atomic_fetch_add, dp, vp, vs, &discard);
+            return UCS_OK;
+            /* NOT REACHED */
+#ifdef HAVE_UCP_BITWISE_ATOMICS
+        case UCP_ATOMIC_POST_OP_AND:
+            DIRECT_FETCH_AMO(__atomic_fetch_and, dp, vp, vs, &discard);
+            return UCS_OK;
+            /* NOT REACHED */
+        case UCP_ATOMIC_POST_OP_OR:
+            DIRECT_FETCH_AMO(__atomic_fetch_or, dp, vp, vs, &discard);
+            return UCS_OK;
+            /* NOT REACHED */
+        case UCP_ATOMIC_POST_OP_XOR:
+            DIRECT_FETCH_AMO(__atomic_fetch_xor, dp, vp, vs, &discard);
+            return UCS_OK;
+            /* NOT REACHED */
+#endif  /* HAVE_UCP_BITWISE_ATOMICS */
+        default:
+            break;              /* let UCX handle it */
+        }
+    }
+
+    get_remote_key_and_addr(ch, (uint64_t) t, pe, &r_key, &r_t);
+    ep = lookup_ucp_ep(ch, pe);
+
+    return ucp_atomic_post(ep, uapo, rv, vs, r_t, r_key);
+}
+
+/*
+ * fetching AMOs: target t, (optional) condition c, value v
+ */
+
+/*
+ * if t is mapped here, do the AMO ourselves.  Returns true if done.
+ */
+inline static bool
+direct_fetching_amo(shmemc_context_h ch,
+                    ucp_atomic_fetch_op_t op,
+                    void *t, void *vp, size_t vs,
+                    int pe,
+                    void *retp)
+{
+    void *dp = lookup_direct_addr(ch, (uint64_t) t, pe);
+
+    if (dp == NULL) {
+        return false;
+        /* NOT REACHED */
+    }
+
+    switch (op) {
+    case UCP_ATOMIC_FETCH_OP_FADD:
+        DIRECT_FETCH_AMO(__atomic_fetch_add, dp, vp, vs, retp);
+        return true;
+        /* NOT REACHED */
+    case UCP_ATOMIC_FETCH_OP_SWAP:
+        DIRECT_FETCH_AMO(__atomic_exchange_n, dp, vp, vs, retp);
+        return true;
+        /* NOT REACHED */
+    case UCP_ATOMIC_FETCH_OP_CSWAP:
+        /* vp is the condition, retp primed with new value */
+        DIRECT_CSWAP_AMO(dp, vp, vs, retp);
+        return true;
+        /* NOT REACHED */
+#ifdef HAVE_UCP_BITWISE_ATOMICS
+    case UCP_ATOMIC_FETCH_OP_FAND:
+        DIRECT_FETCH_AMO(__atomic_fetch_and, dp, vp, vs, retp);
+        return true;
+        /* NOT REACHED */
+    case UCP_ATOMIC_FETCH_OP_FOR:
+        DIRECT_FETCH_AMO(__atomic_fetch_or, dp, vp, vs, retp);
+        return true;
+        /* NOT REACHED */
+    case UCP_ATOMIC_FETCH_OP_FXOR:
+        DIRECT_FETCH_AMO(__atomic_fetch_xor, dp, vp, vs, retp);
+        return true;
+        /* NOT REACHED */
+#endif  /* HAVE_UCP_BITWISE_ATOMICS */
+    default:
+        return false;           /* let UCX handle it */
+        /* NOT REACHED */
+    }
+}
+
+static ucs_status_t
+helper_fetching_amo(shmemc_context_h ch,
+                    ucp_atomic_fetch_op_t op,
+                    void *t, void *vp, size_t vs,
+                    int pe,
+                    void *retp)
+{
+    ucp_rkey_h r_key;
+    uint64_t r_t;
+    ucp_ep_h ep;
+    uint64_t rv = *(uint64_t *) vp;
+    ucs_status_ptr_t sp;
+
+    if (direct_fetching_amo(ch, op, t, vp, vs, pe, retp)) {
+        return UCS_OK;
+        /* NOT REACHED */
+    }
+
+    get_remote_key_and_addr(ch, (uint64_t) t, pe, &r_key, &r_t);
+    ep = lookup_ucp_ep(ch, pe);
+
+    sp = ucp_atomic_fetch_nb(ep,
+                             op,
+                             rv, retp, vs,
+                             r_t, r_key, nb_callback);
+
+    return check_wait_for_request(ch, sp);
+}
+
+/*
+ * non-blocking version: don't wait for the value, but count it as in
+ * flight on the context until UCX tells us it has arrived.  Quiet
+ * waits for the count to drain.
+ */
+
+#ifdef HAVE_UCP_ATOMIC_OP_NBX
+
+inline static ucp_atomic_op_t
+nbx_atomic_op(ucp_atomic_fetch_op_t op)
+{
+    switch (op) {
+    case UCP_ATOMIC_FETCH_OP_FADD:
+        return UCP_ATOMIC_OP_ADD;
+    case UCP_ATOMIC_FETCH_OP_SWAP:
+        return UCP_ATOMIC_OP_SWAP;
+    case UCP_ATOMIC_FETCH_OP_CSWAP:
+        return UCP_ATOMIC_OP_CSWAP;
+#ifdef HAVE_UCP_BITWISE_ATOMICS
+    case UCP_ATOMIC_FETCH_OP_FAND:
+        return UCP_ATOMIC_OP_AND;
+    case UCP_ATOMIC_FETCH_OP_FOR:
+        return UCP_ATOMIC_OP_OR;
+    case UCP_ATOMIC_FETCH_OP_FXOR:
+        return UCP_ATOMIC_OP_XOR;
+#endif  /* HAVE_UCP_BITWISE_ATOMICS */
+    default:
+        shmemu_fatal("unknown fetching atomic operation %d", (int) op);
+        /* NOT REACHED */
+        return UCP_ATOMIC_OP_ADD;
+    }
+}
+
+static void
+fetch_nbi_callback(void *req, ucs_status_t status, void *user_data)
+{
+    shmemc_context_h ch = (shmemc_context_h) user_data;
+
+    shmemu_assert(status == UCS_OK,
+                  "non-blocking fetching AMO failed (status: %s)",
+                  ucs_status_string(status));
+
+    ucp_request_free(req);
+
+    __atomic_sub_fetch(& ch->nfetches, 1, __ATOMIC_RELEASE);
+}
+
+#endif  /* HAVE_UCP_ATOMIC_OP_NBX */
+
+static ucs_status_t
+helper_fetching_amo_nbi(shmemc_context_h ch,
+                        ucp_atomic_fetch_op_t op,
+                        void *t, void *vp, size_t vs,
+                        int pe,
+                        void *retp)
+{
+    ucp_rkey_h r_key;
+    uint64_t r_t;
+    ucp_ep_h ep;
+    ucs_status_ptr_t sp;
+
+    if (direct_fetching_amo(ch, op, t, vp, vs, pe, retp)) {
+        return UCS_OK;
+        /* NOT REACHED */
+    }
+
+    get_remote_key_and_addr(ch, (uint64_t) t, pe, &r_key, &r_t);
+    ep = lookup_ucp_ep(ch, pe);
+
+#ifdef HAVE_UCP_ATOMIC_OP_NBX
+    {
+        ucp_request_param_t prm;
+
+        prm.op_attr_mask =
+            UCP_OP_ATTR_FIELD_CALLBACK     |
+            UCP_OP_ATTR_FIELD_USER_DATA    |
+            UCP_OP_ATTR_FIELD_DATATYPE     |
+            UCP_OP_ATTR_FIELD_REPLY_BUFFER;
+        prm.cb.send = fetch_nbi_callback;
+        prm.user_data = ch;
+        prm.datatype = ucp_dt_make_contig(vs);
+        prm.reply_buffer = retp;
+
+        __atomic_add_fetch(& ch->nfetches, 1, __ATOMIC_RELAXED);
+
+        sp = ucp_atomic_op_nbx(ep, nbx_atomic_op(op), vp, 1,
+                               r_t, r_key, &prm);
+
+        if (UCS_PTR_IS_PTR(sp)) {
+            return UCS_INPROGRESS; /* callback retires it */
+            /* NOT REACHED */
+        }
+
+        /* completed (or failed) immediately, no callback */
+        __atomic_sub_fetch(& ch->nfetches, 1, __ATOMIC_RELEASE);
+
+        return UCS_PTR_STATUS(sp);
+    }
+#else
+    /* no way to find the context from the callback: let the worker
+     * flush in quiet complete it */
+    sp = ucp_atomic_fetch_nb(ep,
+                             op,
+                             *(uint64_t *) vp, retp, vs,
+                             r_t, r_key, nb_callback);
+
+    if (UCS_PTR_IS_PTR(sp)) {
+        ucp_request_free(sp);
+        return UCS_INPROGRESS;
+        /* NOT REACHED */
+    }
+
+    return UCS_PTR_STATUS(sp);
+#endif  /* HAVE_UCP_ATOMIC_OP_NBX */
+}
+
+/**
+ * API
+ *
+ **/
+
+/*
+ * make progress on a context
+ */
+
+inline static void
+helper_ctx_progress(shmem_ctx_t ctx)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+
+    (void) ucp_worker_progress(ch->w);
+}
+
+void
+shmemc_ctx_progress(shmem_ctx_t ctx)
+{
+    helper_ctx_progress(ctx);
+}
+
+void
+shmemc_progress(void)
+{
+    helper_ctx_progress(SHMEM_CTX_DEFAULT);
+}
+
+/*
+ * -- accessible memory pointers -----------------------------------------
+ */
+
+/*
+ * See if addr is reachable using given context.  Return usable
+ * address if so, otherwise NULL.
+ */
+
+inline static void *
+ctx_ptr_self_check(const void *addr)
+{
+    /* is it remotely accessible? */
+    if (lookup_region((uint64_t) addr) >= 0) {
+        return (void *) addr;
+    }
+    else {
+        return NULL;
+    }
+}
+
+inline static void *
+ctx_ptr_remote_check(shmem_ctx_t ctx, const void *addr, int pe)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    uint64_t r_addr;            /* address on other PE */
+    ucp_rkey_h r_key;            /* rkey for remote address */
+    void *usable_addr = NULL;
+    ucs_status_t s;
+
+    get_remote_key_and_addr(ch, (uint64_t) addr, pe, &r_key, &r_addr);
+
+    s = ucp_rkey_ptr(r_key, r_addr, &usable_addr);
+    if (s == UCS_OK) {
+        return usable_addr;
+    }
+    else {
+        return NULL;
+    }
+}
+
+void *
+shmemc_ctx_ptr(shmem_ctx_t ctx, const void *addr, int pe)
+{
+    /* self short-circuit */
+    if (shmemu_unlikely(pe == proc.rank)) {
+        return ctx_ptr_self_check(addr);
+        /* NOT REACHED */
+    }
+
+    /* if UCX has check routine, do a full test, otherwise give up */
+#ifdef HAVE_UCP_RKEY_PTR
+    return ctx_ptr_remote_check(ctx, addr, pe);
+#else
+    return NULL;
+#endif  /* HAVE_UCP_RKEY_PTR */
+}
+
+/*
+ * Return non-zero if adddress is remotely accessible, 0 otherwise.
+ *
+ */
+int
+shmemc_addr_accessible(const void *addr, int pe)
+{
+    uint64_t uaddr = (uint64_t) addr;
+
+    NO_WARN_UNUSED(pe);         /* if aligned addresses */
+
+#ifndef ENABLE_ALIGNED_ADDRESSES
+    /* need to know where PE's heaps are */
+    shmemc_pmi_fetch_peer(pe);
+#endif /* ! ENABLE_ALIGNED_ADDRESSES */
+
+    return translate_address(uaddr, pe) > 0;
+}
+
+/*
+ * Return non-zero if a valid PE #, 0 otherwise.
+ *
+ * N.B. this function was originally meant to test which ranks were
+ * SHMEM in mixed SHMEM/MPI programs.  Here we just check the rank
+ * number is valid and assume reachability, although might want to
  * revisit for FT/resilience purposes.
  */
 int
 shmemc_pe_accessible(int pe)
 {
-    return shmemu_valid_pe_number(pe);
+    return shmemu_valid_pe_number(pe);
+}
+
+/*
+ * -- atomics ------------------------------------------------------------
+ */
+
+/**
+ * AMO API
+ **/
+
+/*
+ * add
+ */
+
+void
+shmemc_ctx_add(shmem_ctx_t ctx,
+               void *t, void *vp, size_t vs,
+               int pe)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+
+    helper_posted_amo(ch, UCP_ATOMIC_POST_OP_ADD, t, vp, vs, pe);
+}
+
+/*
+ * inc = add 1
+ */
+
+/*
+ * fetch-and-add
+ */
+
+void
+shmemc_ctx_fadd(shmem_ctx_t ctx,
+                void *t, void *vp, size_t vs,
+                int pe,
+                void *retp)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+
+    helper_fetching_amo(ch,
+                        UCP_ATOMIC_FETCH_OP_FADD,
+                        t, vp, vs, pe, retp);
+}
+
+/*
+ * fetch-and-inc: finc = fadd 1
+ */
+
+/*
+ * swaps
+ */
+
+void
+shmemc_ctx_swap(shmem_ctx_t ctx,
+                void *t, void *vp, size_t vs,
+                int pe,
+                void *retp)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    ucs_status_t s;
+
+    s = helper_fetching_amo(ch,
+                            UCP_ATOMIC_FETCH_OP_SWAP,
+                            t, vp, vs,
+                            pe,
+                            retp);
+
+    shmemu_assert(s == UCS_OK,
+                  "AMO swap failed (status: %s)",
+                  ucs_status_string(s));
+}
+
+void
+shmemc_ctx_cswap(shmem_ctx_t ctx,
+                 void *t, void *c, void *vp, size_t vs,
+                 int pe,
+                 void *retp)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    ucs_status_t s;
+
+    memcpy(retp, vp, vs);       /* prime the value */
+
+    s = helper_fetching_amo(ch,
+                            UCP_ATOMIC_FETCH_OP_CSWAP,
+                            t, c, vs,
+                            pe,
+                            retp);
+
+    shmemu_assert(s == UCS_OK,
+                  "AMO conditional swap failed (status: %s)",
+                  ucs_status_string(s));
+}
+
+/*
+ * non-blocking fetch-and-add and swaps: retp is only valid after
+ * quiet
+ */
+
+void
+shmemc_ctx_fadd_nbi(shmem_ctx_t ctx,
+                    void *t, void *vp, size_t vs,
+                    int pe,
+                    void *retp)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    ucs_status_t s;
+
+    s = helper_fetching_amo_nbi(ch,
+                                UCP_ATOMIC_FETCH_OP_FADD,
+                                t, vp, vs,
+                                pe,
+                                retp);
+
+    shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                  "non-blocking AMO fetch-add failed (status: %s)",
+                  ucs_status_string(s));
+}
+
+void
+shmemc_ctx_swap_nbi(shmem_ctx_t ctx,
+                    void *t, void *vp, size_t vs,
+                    int pe,
+                    void *retp)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    ucs_status_t s;
+
+    s = helper_fetching_amo_nbi(ch,
+                                UCP_ATOMIC_FETCH_OP_SWAP,
+                                t, vp, vs,
+                                pe,
+                                retp);
+
+    shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                  "non-blocking AMO swap failed (status: %s)",
+                  ucs_status_string(s));
+}
+
+void
+shmemc_ctx_cswap_nbi(shmem_ctx_t ctx,
+                     void *t, void *c, void *vp, size_t vs,
+                     int pe,
+                     void *retp)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    ucs_status_t s;
+
+    memcpy(retp, vp, vs);       /* prime the value */
+
+    s = helper_fetching_amo_nbi(ch,
+                                UCP_ATOMIC_FETCH_OP_CSWAP,
+                                t, c, vs,
+                                pe,
+                                retp);
+
+    shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                  "non-blocking AMO conditional swap failed (status: %s)",
+                  ucs_status_string(s));
+}
+
+/*
+ * fetch handled via typed-0-swap
+ */
+
+/*
+ * -- atomics UCX can't do natively ----------------------------------------
+ *
+ * The extension ops (add, min/max, incl. floating point) are carried
+ * out by the target PE itself: an active message takes the operation
+ * over, the target's progress engine applies it with a processor
+ * atomic and replies with the old value.  One round trip, however
+ * contended the location is.
+ *
+ * Whether an operation goes this way is decided at startup, by
+ * whether the default worker accepted the handlers.  Otherwise the
+ * initiator loops on compare-and-swap.
+ *
+ * NB the target's processor atomics are not atomic with respect to
+ * network atomics on the same location, so don't mix the two kinds
+ * of operation on one variable without synchronizing.  The standard
+ * bitwise ops have to be atomic with the other standard ones, so
+ * without native support they always loop on network
+ * compare-and-swap.
+ */
+
+#define SHMEMC_AMO_BIT(_op) (1U << (_op))
+
+/*
+ * combine current value "cur" with operand "val", both held in the
+ * low "size" bytes of a zeroed 64-bit word
+ */
+
+#define AMO_TYPED_APPLY(_type)                                          \
+    do {                                                                \
+        _type a, b, r;                                                  \
+                                                                        \
+        memcpy(&a, &cur, sizeof(a));                                    \
+        memcpy(&b, &val, sizeof(b));                                    \
+        switch (op) {                                                   \
+        case SHMEMC_AMO_ADD:                                            \
+            r = a + b;                                                  \
+            break;                                                      \
+        case SHMEMC_AMO_MIN:                                            \
+            r = (b < a) ? b : a;                                        \
+            break;                                                      \
+        default:                                                        \
+            r = (b > a) ? b : a;                                        \
+            break;                                                      \
+        }                                                               \
+        memcpy(&res, &r, sizeof(r));                                    \
+    } while (0)
+
+static uint64_t
+amo_apply(shmemc_amo_op_t op, shmemc_amo_kind_t kind, size_t size,
+          uint64_t cur, uint64_t val)
+{
+    uint64_t res = 0;
+
+    switch (op) {
+    case SHMEMC_AMO_AND:
+        return cur & val;
+    case SHMEMC_AMO_OR:
+        return cur | val;
+    case SHMEMC_AMO_XOR:
+        return cur ^ val;
+    case SHMEMC_AMO_ADD:
+        if (kind != SHMEMC_AMO_FLOAT) {
+            return cur + val;   /* 2's complement, sign doesn't matter */
+            /* NOT REACHED */
+        }
+        break;
+    default:
+        break;
+    }
+
+    switch (kind) {
+    case SHMEMC_AMO_SIGNED:
+        if (size == 4) {
+            AMO_TYPED_APPLY(int32_t);
+        }
+        else {
+            AMO_TYPED_APPLY(int64_t);
+        }
+        break;
+    case SHMEMC_AMO_UNSIGNED:
+        if (size == 4) {
+            AMO_TYPED_APPLY(uint32_t);
+        }
+        else {
+            AMO_TYPED_APPLY(uint64_t);
+        }
+        break;
+    case SHMEMC_AMO_FLOAT:
+        if (size == 4) {
+            AMO_TYPED_APPLY(float);
+        }
+        else {
+            AMO_TYPED_APPLY(double);
+        }
+        break;
+    default:
+        shmemu_fatal("unknown atomic operand kind %d", (int) kind);
+        /* NOT REACHED */
+        break;
+    }
+
+    return res;
 }
 
 /*
- * -- atomics ------------------------------------------------------------
+ * apply operation to local memory with a processor compare-and-swap
+ * loop.  Return old value.
  */
 
-/**
- * AMO API
- **/
+#define AMO_LOCAL_CAS(_type)                                            \
+    do {                                                                \
+        _type *p = (_type *) addr;                                      \
+        _type was = __atomic_load_n(p, __ATOMIC_ACQUIRE);               \
+        _type want;                                                     \
+                                                                        \
+        do {                                                            \
+            uint64_t w = 0;                                             \
+                                                                        \
+            memcpy(&w, &was, sizeof(was));                              \
+            w = amo_apply(op, kind, size, w, val);                      \
+            memcpy(&want, &w, sizeof(want));                            \
+        } while (! __atomic_compare_exchange_n(p, &was, want, false,    \
+                                               __ATOMIC_SEQ_CST,        \
+                                               __ATOMIC_ACQUIRE));      \
+        memcpy(&old, &was, sizeof(was));                                \
+    } while (0)
+
+static uint64_t
+amo_local(void *addr,
+          shmemc_amo_op_t op, shmemc_amo_kind_t kind, size_t size,
+          uint64_t val)
+{
+    uint64_t old = 0;
+
+    if (size == 4) {
+        AMO_LOCAL_CAS(uint32_t);
+    }
+    else {
+        AMO_LOCAL_CAS(uint64_t);
+    }
+
+    return old;
+}
 
 /*
- * add
+ * no active messages: compare-and-swap from here until it sticks.
+ * Each failed swap hands back the current value for the next try.
  */
 
-void
-shmemc_ctx_add(shmem_ctx_t ctx,
-               void *t, void *vp, size_t vs,
-               int pe)
+static void
+amo_cas_loop(shmemc_context_h ch,
+             shmemc_amo_op_t op, shmemc_amo_kind_t kind,
+             void *t, uint64_t val, size_t vs,
+             int pe,
+             uint64_t *oldp)
 {
-    shmemc_context_h ch = (shmemc_context_h) ctx;
+    uint64_t cur = 0;
 
-    helper_posted_amo(ch, UCP_ATOMIC_POST_OP_ADD, t, vp, vs, pe);
+    shmemc_ctx_fetch(ch, t, vs, pe, &cur);
+
+    for (;;) {
+        uint64_t want = amo_apply(op, kind, vs, cur, val);
+        uint64_t got = 0;
+
+        shmemc_ctx_cswap(ch, t, &cur, &want, vs, pe, &got);
+        if (got == cur) {
+            break;
+            /* NOT REACHED */
+        }
+        cur = got;
+    }
+
+    *oldp = cur;
 }
 
-/*
- * inc = add 1
- */
+#ifdef HAVE_UCP_AM_SEND_NB
+
+#define AMO_AM_REQUEST_ID 1     /* initiator -> target */
+#define AMO_AM_REPLY_ID   2     /* target -> initiator */
+
+typedef struct amo_am_request {
+    uint64_t addr;              /* target address, on target */
+    uint64_t value;             /* operand */
+    uint64_t cookie;            /* initiator's wait record */
+    uint8_t op;                 /* shmemc_amo_op_t */
+    uint8_t kind;               /* shmemc_amo_kind_t */
+    uint8_t size;               /* operand bytes, 4 or 8 */
+} amo_am_request_t;
+
+typedef struct amo_am_reply {
+    uint64_t cookie;            /* from request */
+    uint64_t old;               /* value before operation */
+} amo_am_reply_t;
+
+typedef struct amo_am_wait {
+    int done;                   /* reply arrived */
+    uint64_t old;               /* fetched value */
+} amo_am_wait_t;
 
 /*
- * fetch-and-add
+ * replies that UCX hasn't finished sending yet.  Only touched from
+ * the request handler, which the worker serializes, and at teardown.
  */
 
-void
-shmemc_ctx_fadd(shmem_ctx_t ctx,
-                void *t, void *vp, size_t vs,
-                int pe,
-                void *retp)
+typedef struct amo_am_pending {
+    struct amo_am_pending *next;
+    ucs_status_ptr_t req;
+    amo_am_reply_t reply;
+} amo_am_pending_t;
+
+static amo_am_pending_t *amo_pending = NULL;
+
+static void
+amo_am_reap_replies(void)
 {
-    shmemc_context_h ch = (shmemc_context_h) ctx;
+    amo_am_pending_t **pp = &amo_pending;
 
-    helper_fetching_amo(ch,
-                        UCP_ATOMIC_FETCH_OP_FADD,
-                        t, vp, vs, pe, retp);
+    while (*pp != NULL) {
+        amo_am_pending_t *cur = *pp;
+
+        if (UCX_REQUEST_CHECK(cur->req) != UCS_INPROGRESS) {
+            ucp_request_free(cur->req);
+            *pp = cur->next;
+            free(cur);
+        }
+        else {
+            pp = & cur->next;
+        }
+    }
 }
 
-/*
- * fetch-and-inc: finc = fadd 1
- */
+static ucs_status_t
+amo_am_request_handler(void *arg, void *data, size_t length,
+                       ucp_ep_h reply_ep, unsigned flags)
+{
+    amo_am_request_t rq;
+    amo_am_pending_t *app;
 
-/*
- * swaps
- */
+    NO_WARN_UNUSED(arg);
+    NO_WARN_UNUSED(flags);
 
-void
-shmemc_ctx_swap(shmem_ctx_t ctx,
-                void *t, void *vp, size_t vs,
-                int pe,
-                void *retp)
+    shmemu_assert(length == sizeof(rq) && reply_ep != NULL,
+                  "malformed atomic request (%lu bytes)",
+                  (unsigned long) length);
+
+    memcpy(&rq, data, sizeof(rq));
+
+    amo_am_reap_replies();
+
+    app = (amo_am_pending_t *) malloc(sizeof(*app));
+    shmemu_assert(app != NULL, "can't allocate atomic reply");
+
+    app->reply.cookie = rq.cookie;
+    app->reply.old = amo_local((void *) rq.addr,
+                               (shmemc_amo_op_t) rq.op,
+                               (shmemc_amo_kind_t) rq.kind,
+                               rq.size,
+                               rq.value);
+
+    app->req = ucp_am_send_nb(reply_ep, AMO_AM_REPLY_ID,
+                              &app->reply, sizeof(app->reply),
+                              ucp_dt_make_contig(1),
+                              nb_callback, 0);
+
+    if (UCS_PTR_IS_PTR(app->req)) {
+        app->next = amo_pending;
+        amo_pending = app;
+    }
+    else {
+        shmemu_assert(! UCS_PTR_IS_ERR(app->req),
+                      "atomic reply failed (status: %s)",
+                      ucs_status_string(UCS_PTR_STATUS(app->req)));
+        free(app);
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t
+amo_am_reply_handler(void *arg, void *data, size_t length,
+                     ucp_ep_h reply_ep, unsigned flags)
 {
-    shmemc_context_h ch = (shmemc_context_h) ctx;
+    amo_am_reply_t rp;
+    amo_am_wait_t *wp;
+
+    NO_WARN_UNUSED(arg);
+    NO_WARN_UNUSED(reply_ep);
+    NO_WARN_UNUSED(flags);
+
+    shmemu_assert(length == sizeof(rp),
+                  "malformed atomic reply (%lu bytes)",
+                  (unsigned long) length);
+
+    memcpy(&rp, data, sizeof(rp));
+
+    wp = (amo_am_wait_t *) rp.cookie;
+    wp->old = rp.old;
+    __atomic_store_n(& wp->done, 1, __ATOMIC_RELEASE);
+
+    return UCS_OK;
+}
+
+static void
+amo_am_fetch(shmemc_context_h ch,
+             shmemc_amo_op_t op, shmemc_amo_kind_t kind,
+             void *t, uint64_t val, size_t vs,
+             int pe,
+             uint64_t *oldp)
+{
+    amo_am_request_t rq;
+    amo_am_wait_t w;
+    ucs_status_ptr_t req;
     ucs_status_t s;
+    ucp_ep_h ep;
 
-    s = helper_fetching_amo(ch,
-                            UCP_ATOMIC_FETCH_OP_SWAP,
-                            t, vp, vs,
-                            pe,
-                            retp);
+    /* connecting fetches PE's heap locations (lazy bootstrap) */
+    ep = lookup_ucp_ep(ch, pe);
+
+    rq.addr = translate_address((uint64_t) t, pe);
+    shmemu_assert(rq.addr != 0,
+                  "can't find address of %p on PE %d for atomic request",
+                  t, pe);
+    rq.value = val;
+    rq.cookie = (uint64_t) &w;
+    rq.op = (uint8_t) op;
+    rq.kind = (uint8_t) kind;
+    rq.size = (uint8_t) vs;
+
+    w.done = 0;
+
+    req = ucp_am_send_nb(ep, AMO_AM_REQUEST_ID,
+                         &rq, sizeof(rq),
+                         ucp_dt_make_contig(1),
+                         nb_callback, UCP_AM_SEND_REPLY);
+    shmemu_assert(! UCS_PTR_IS_ERR(req),
+                  "atomic request to PE %d failed (status: %s)",
+                  pe, ucs_status_string(UCS_PTR_STATUS(req)));
+
+    /* keep serving requests to us while we wait */
+    while (! __atomic_load_n(& w.done, __ATOMIC_ACQUIRE)) {
+        (void) ucp_worker_progress(ch->w);
+        if (ch != defcp) {
+            (void) ucp_worker_progress(defcp->w);
+        }
+    }
 
+    /* reply means request was delivered */
+    s = check_wait_for_request(ch, req);
     shmemu_assert(s == UCS_OK,
-                  "AMO swap failed (status: %s)",
-                  ucs_status_string(s));
+                  "atomic request to PE %d failed (status: %s)",
+                  pe, ucs_status_string(s));
+
+    *oldp = w.old;
 }
 
+#endif  /* HAVE_UCP_AM_SEND_NB */
+
+/*
+ * Every worker can get replies, the default one also gets requests.
+ * The default worker is created first and is the probe: if it can't
+ * take the handlers, nothing goes by active message.
+ */
+
 void
-shmemc_ctx_cswap(shmem_ctx_t ctx,
-                 void *t, void *c, void *vp, size_t vs,
-                 int pe,
-                 void *retp)
+shmemc_ucx_amo_handlers_init(shmemc_context_h ch)
 {
-    shmemc_context_h ch = (shmemc_context_h) ctx;
+#ifdef HAVE_UCP_AM_SEND_NB
     ucs_status_t s;
 
-    memcpy(retp, vp, vs);       /* prime the value */
+    if ((ch != defcp) && (proc.comms.amo_am_ops == 0)) {
+        return;
+        /* NOT REACHED */
+    }
 
-    s = helper_fetching_amo(ch,
-                            UCP_ATOMIC_FETCH_OP_CSWAP,
-                            t, c, vs,
-                            pe,
-                            retp);
+    s = ucp_worker_set_am_handler(ch->w, AMO_AM_REQUEST_ID,
+                                  amo_am_request_handler, NULL,
+                                  UCP_AM_FLAG_WHOLE_MSG);
+    if (s == UCS_OK) {
+        s = ucp_worker_set_am_handler(ch->w, AMO_AM_REPLY_ID,
+                                      amo_am_reply_handler, NULL,
+                                      UCP_AM_FLAG_WHOLE_MSG);
+    }
 
-    shmemu_assert(s == UCS_OK,
-                  "AMO conditional swap failed (status: %s)",
-                  ucs_status_string(s));
+    if (ch != defcp) {
+        shmemu_assert(s == UCS_OK,
+                      "can't set up atomics for context #%lu (status: %s)",
+                      ch->id, ucs_status_string(s));
+        return;
+        /* NOT REACHED */
+    }
+
+    if (s == UCS_OK) {
+        proc.comms.amo_am_ops =
+            SHMEMC_AMO_BIT(SHMEMC_AMO_ADD) |
+            SHMEMC_AMO_BIT(SHMEMC_AMO_MIN) |
+            SHMEMC_AMO_BIT(SHMEMC_AMO_MAX);
+    }
+    else {
+        proc.comms.amo_am_ops = 0;
+    }
+
+    logger(LOG_INIT,
+           "atomics by active message: %s (ops mask %#x)",
+           (s == UCS_OK) ? "yes" : "no",
+           proc.comms.amo_am_ops);
+#else
+    NO_WARN_UNUSED(ch);
+
+    proc.comms.amo_am_ops = 0;
+#endif  /* HAVE_UCP_AM_SEND_NB */
 }
 
 /*
- * fetch handled via typed-0-swap
+ * requests are only served on the default worker: wait for its
+ * outstanding replies before it goes away
  */
 
+void
+shmemc_ucx_amo_handlers_finalize(shmemc_context_h ch)
+{
+#ifdef HAVE_UCP_AM_SEND_NB
+    if ((ch != defcp) || (proc.comms.amo_am_ops == 0)) {
+        return;
+        /* NOT REACHED */
+    }
+
+    amo_am_reap_replies();
+    while (amo_pending != NULL) {
+        (void) ucp_worker_progress(ch->w);
+        amo_am_reap_replies();
+    }
+#else
+    NO_WARN_UNUSED(ch);
+#endif  /* HAVE_UCP_AM_SEND_NB */
+}
+
+void
+shmemc_ctx_fetch_op(shmem_ctx_t ctx,
+                    shmemc_amo_op_t op, shmemc_amo_kind_t kind,
+                    void *t, void *vp, size_t vs,
+                    int pe,
+                    void *retp)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    uint64_t val = 0, old = 0;
+    void *dp = lookup_direct_addr(ch, (uint64_t) t, pe);
+
+    shmemu_assert(vs == 4 || vs == 8,
+                  "atomic operand size %lu not supported",
+                  (unsigned long) vs);
+
+    memcpy(&val, vp, vs);
+
+    if (dp != NULL) {
+        old = amo_local(dp, op, kind, vs, val);
+    }
+    else if (pe == proc.rank) {
+        old = amo_local(t, op, kind, vs, val);
+    }
+#ifdef HAVE_UCP_AM_SEND_NB
+    else if (proc.comms.amo_am_ops & SHMEMC_AMO_BIT(op)) {
+        amo_am_fetch(ch, op, kind, t, val, vs, pe, &old);
+    }
+#endif  /* HAVE_UCP_AM_SEND_NB */
+    else {
+        amo_cas_loop(ch, op, kind, t, val, vs, pe, &old);
+    }
+
+    memcpy(retp, &old, vs);
+}
+
 /*
  * bitwise helpers
  *
@@ -554,42 +1695,24 @@ HELPER_BITWISE_ATOMIC(XOR, xor)
 
 #else  /* ! HAVE_UCP_BITWISE_ATOMICS */
 
-#define HELPER_BITWISE_FETCH_ATOMIC(_op, _opname)                       \
+#define HELPER_BITWISE_FETCH_ATOMIC(_amo_op, _opname)                   \
     inline static void                                                  \
     helper_atomic_fetch_##_opname(shmemc_context_h ch,                  \
                                   void *t, void *vp, size_t vs,         \
                                   int pe,                               \
                                   void *retp)                           \
     {                                                                   \
-        /* make sure zeroed for smaller types */                        \
-        uint64_t ret = 0, rval = 0, rval_orig = 0, vcomp = 0;           \
-        ucs_status_t s;                                                 \
-        uint64_t r_t;                                                   \
-        ucp_rkey_h r_key;                                               \
-        ucp_ep_h ep;                                                    \
-                                                                        \
-        memcpy(&vcomp, vp, vs); /* save comparator */                   \
-        get_remote_key_and_addr(ch, (uint64_t) t, pe, &r_key, &r_t);    \
-        ep = lookup_ucp_ep(ch, pe);                                     \
+        uint64_t val = 0, old = 0;                                      \
                                                                         \
-        do {                                                            \
-            s = ucp_get(ep, &rval_orig, sizeof(rval_orig),              \
-                        r_t, r_key);                                    \
-            shmemu_assert(s == UCS_OK,                                  \
-                          "AMO fetch failed in CAS (status: %s)",       \
-                          ucs_status_string(s));                        \
-            rval = (rval_orig) _op vcomp;                               \
-                                                                        \
-            s = ucp_atomic_cswap64(ep, rval_orig, rval,                 \
-                                   r_t, r_key, &ret);                   \
-        } while (ret != rval_orig);                                     \
-                                                                        \
-        memcpy(retp, &ret, vs); /* copy out answer */                   \
+        memcpy(&val, vp, vs);                                           \
+        amo_cas_loop(ch, _amo_op, SHMEMC_AMO_UNSIGNED,                  \
+                     t, val, vs, pe, &old);                             \
+        memcpy(retp, &old, vs);                                         \
     }
 
-HELPER_BITWISE_FETCH_ATOMIC(|, or)
-HELPER_BITWISE_FETCH_ATOMIC(&, and)
-HELPER_BITWISE_FETCH_ATOMIC(^, xor)
+HELPER_BITWISE_FETCH_ATOMIC(SHMEMC_AMO_OR,  or)
+HELPER_BITWISE_FETCH_ATOMIC(SHMEMC_AMO_AND, and)
+HELPER_BITWISE_FETCH_ATOMIC(SHMEMC_AMO_XOR, xor)
 
 #define HELPER_BITWISE_ATOMIC(_opname)                                  \
     inline static void                                                  \
@@ -632,6 +1755,52 @@ SHMEMC_CTX_FETCH_BITWISE(and)
 SHMEMC_CTX_FETCH_BITWISE(or)
 SHMEMC_CTX_FETCH_BITWISE(xor)
 
+/*
+ * non-blocking fetched-bitwise.  Without native UCX support these
+ * are emulated, and simply complete before returning.
+ */
+
+#ifdef HAVE_UCP_BITWISE_ATOMICS
+
+#define SHMEMC_CTX_FETCH_BITWISE_NBI(_ucp_op, _op)                      \
+    void                                                                \
+    shmemc_ctx_fetch_##_op##_nbi(shmem_ctx_t ctx,                       \
+                                 void *t, void *vp, size_t vs,          \
+                                 int pe,                                \
+                                 void *retp)                            \
+    {                                                                   \
+        shmemc_context_h ch = (shmemc_context_h) ctx;                   \
+        const ucs_status_t s =                                          \
+            helper_fetching_amo_nbi(ch,                                 \
+                                    MAKE_UCP_FETCH_OP(_ucp_op),         \
+                                    t, vp, vs,                          \
+                                    pe,                                 \
+                                    retp);                              \
+                                                                        \
+        shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,               \
+                      "non-blocking AMO fetch op \"%s\" failed "        \
+                      "(status: %s)",                                   \
+                      #_op, ucs_status_string(s));                      \
+    }
+
+#else  /* ! HAVE_UCP_BITWISE_ATOMICS */
+
+#define SHMEMC_CTX_FETCH_BITWISE_NBI(_ucp_op, _op)                      \
+    void                                                                \
+    shmemc_ctx_fetch_##_op##_nbi(shmem_ctx_t ctx,                       \
+                                 void *t, void *vp, size_t vs,          \
+                                 int pe,                                \
+                                 void *retp)                            \
+    {                                                                   \
+        shmemc_ctx_fetch_##_op(ctx, t, vp, vs, pe, retp);               \
+    }
+
+#endif  /* HAVE_UCP_BITWISE_ATOMICS */
+
+SHMEMC_CTX_FETCH_BITWISE_NBI(AND, and)
+SHMEMC_CTX_FETCH_BITWISE_NBI(OR,  or)
+SHMEMC_CTX_FETCH_BITWISE_NBI(XOR, xor)
+
 /*
  * bitwise
  */
@@ -664,22 +1833,130 @@ shmemc_ctx_set(shmem_ctx_t ctx,
 
     NO_WARN_UNUSED(ts);
 
-    shmemc_ctx_swap(ctx, tp, vp, vs, pe, &zap);
+    shmemc_ctx_swap(ctx, tp, vp, vs, pe, &zap);
+
+    NO_WARN_UNUSED(zap);
+}
+
+void
+shmemc_ctx_fetch(shmem_ctx_t ctx,
+                 void *tp, size_t ts,
+                 int pe,
+                 void *valp)
+{
+    uint64_t zero = 0;
+
+    shmemc_ctx_fadd(ctx, tp, &zero, ts, pe, valp);
+}
+
+/*
+ * -- staged puts --------------------------------------------------------
+ *
+ * A non-blocking put from memory UCX hasn't seen (stack, malloc) can
+ * cost a registration.  Mid-sized sources are copied into the
+ * registered bounce pool instead, and the copy goes back when the put
+ * completes locally.  Sources already in the pool go straight out.
+ */
+
+#ifdef HAVE_UCP_PUT_NBX
+
+/* UCX copies anything smaller than this into its own buffers anyway */
+#define BOUNCE_MIN_PUT 1024
+
+inline static bool
+in_bounce_pool(const void *addr)
+{
+    const mem_info_t *bp = & proc.comms.bounce;
+
+    return (bp->base <= (uint64_t) addr) && ((uint64_t) addr < bp->end);
+}
+
+static void
+bounce_put_callback(void *req, ucs_status_t status, void *user_data)
+{
+    shmemu_assert(status == UCS_OK,
+                  "staged put failed (status: %s)",
+                  ucs_status_string(status));
+
+    shmemc_bounce_free(user_data);
+
+    ucp_request_free(req);
+}
+
+/*
+ * Return true if the put was sent from the pool, false if caller has
+ * to send it
+ */
+static bool
+bounce_put(ucp_ep_h ep, const void *src, size_t nbytes,
+           uint64_t r_dest, ucp_rkey_h r_key)
+{
+    ucp_request_param_t prm;
+    ucs_status_ptr_t sp;
+    void *bp = NULL;
+
+    if (proc.comms.bounce.len == 0) {
+        return false;
+        /* NOT REACHED */
+    }
+
+    if (! in_bounce_pool(src)) {
+        if ((nbytes < BOUNCE_MIN_PUT) || (nbytes > proc.env.bounce_max)) {
+            return false;
+            /* NOT REACHED */
+        }
+        /* symmetric memory is registered already */
+        if (lookup_region((uint64_t) src) >= 0) {
+            return false;
+            /* NOT REACHED */
+        }
+
+        bp = shmemc_bounce_alloc(nbytes);
+        if (bp == NULL) {       /* full, let UCX deal with it */
+            return false;
+            /* NOT REACHED */
+        }
+
+        memcpy(bp, src, nbytes);
+        src = bp;
+    }
+
+    prm.op_attr_mask = 0;
+#ifdef HAVE_UCP_OP_ATTR_FIELD_MEMH
+    prm.op_attr_mask |= UCP_OP_ATTR_FIELD_MEMH;
+    prm.memh = proc.comms.bounce.mh;
+#endif  /* HAVE_UCP_OP_ATTR_FIELD_MEMH */
+    if (bp != NULL) {
+        prm.op_attr_mask |=
+            UCP_OP_ATTR_FIELD_CALLBACK |
+            UCP_OP_ATTR_FIELD_USER_DATA;
+        prm.cb.send = bounce_put_callback;
+        prm.user_data = bp;
+    }
+
+    sp = ucp_put_nbx(ep, src, nbytes, r_dest, r_key, &prm);
+
+    if (UCS_PTR_IS_PTR(sp)) {
+        /* callback retires it, otherwise quiet does */
+        if (bp == NULL) {
+            ucp_request_free(sp);
+        }
+        return true;
+        /* NOT REACHED */
+    }
 
-    NO_WARN_UNUSED(zap);
-}
+    /* completed (or failed) immediately, no callback */
+    shmemc_bounce_free(bp);
 
-void
-shmemc_ctx_fetch(shmem_ctx_t ctx,
-                 void *tp, size_t ts,
-                 int pe,
-                 void *valp)
-{
-    uint64_t zero = 0;
+    shmemu_assert(UCS_PTR_STATUS(sp) == UCS_OK,
+                  "non-blocking put failed (status: %s)",
+                  ucs_status_string(UCS_PTR_STATUS(sp)));
 
-    shmemc_ctx_fadd(ctx, tp, &zero, ts, pe, valp);
+    return true;
 }
 
+#endif  /* HAVE_UCP_PUT_NBX */
+
 /*
  * -- puts & gets --------------------------------------------------------
  */
@@ -697,6 +1974,18 @@ shmemc_ctx_put(shmem_ctx_t ctx,
     ucs_status_ptr_t sp;
 #endif /* HAVE_UCP_PUT_NB */
     ucs_status_t s;
+    void *dp = lookup_direct_addr(ch, (uint64_t) dest, pe);
+
+    if (dp != NULL) {
+        memcpy(dp, src, nbytes);
+        return;
+        /* NOT REACHED */
+    }
+
+    if (combine_put(ch, dest, src, nbytes, pe)) {
+        return;
+        /* NOT REACHED */
+    }
 
     get_remote_key_and_addr(ch, (uint64_t) dest, pe, &r_key, &r_dest);
     ep = lookup_ucp_ep(ch, pe);
@@ -727,6 +2016,13 @@ shmemc_ctx_get(shmem_ctx_t ctx,
     ucs_status_ptr_t sp;
 #endif /* HAVE_UCP_GET_NB */
     ucs_status_t s;
+    void *dp = lookup_direct_addr(ch, (uint64_t) src, pe);
+
+    if (dp != NULL) {
+        memcpy(dest, dp, nbytes);
+        return;
+        /* NOT REACHED */
+    }
 
     get_remote_key_and_addr(ch, (uint64_t) src, pe, &r_key, &r_src);
     ep = lookup_ucp_ep(ch, pe);
@@ -744,10 +2040,6 @@ shmemc_ctx_get(shmem_ctx_t ctx,
                   ucs_status_string(s));
 }
 
-/*
- * strided ops currently build on put/get in upper API
- */
-
 /**
  * Return status from UCP nbi routines probably needs more handling
  *
@@ -763,10 +2055,29 @@ shmemc_ctx_put_nbi(shmem_ctx_t ctx,
     ucp_rkey_h r_key;
     ucp_ep_h ep;
     ucs_status_t s;
+    void *dp = lookup_direct_addr(ch, (uint64_t) dest, pe);
+
+    if (dp != NULL) {
+        memcpy(dp, src, nbytes);
+        return;
+        /* NOT REACHED */
+    }
+
+    if (combine_put(ch, dest, src, nbytes, pe)) {
+        return;
+        /* NOT REACHED */
+    }
 
     get_remote_key_and_addr(ch, (uint64_t) dest, pe, &r_key, &r_dest);
     ep = lookup_ucp_ep(ch, pe);
 
+#ifdef HAVE_UCP_PUT_NBX
+    if (bounce_put(ep, src, nbytes, r_dest, r_key)) {
+        return;
+        /* NOT REACHED */
+    }
+#endif  /* HAVE_UCP_PUT_NBX */
+
     s = ucp_put_nbi(ep, src, nbytes, r_dest, r_key);
     shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
                   "non-blocking put failed");
@@ -782,6 +2093,13 @@ shmemc_ctx_get_nbi(shmem_ctx_t ctx,
     ucp_rkey_h r_key;
     ucp_ep_h ep;
     ucs_status_t s;
+    void *dp = lookup_direct_addr(ch, (uint64_t) src, pe);
+
+    if (dp != NULL) {
+        memcpy(dest, dp, nbytes);
+        return;
+        /* NOT REACHED */
+    }
 
     get_remote_key_and_addr(ch, (uint64_t) src, pe, &r_key, &r_src);
     ep = lookup_ucp_ep(ch, pe);
@@ -792,31 +2110,463 @@ shmemc_ctx_get_nbi(shmem_ctx_t ctx,
 }
 
 /*
- * puts with signals
+ * strided puts & gets
+ *
+ * UCX can only describe the remote side of a transfer as one
+ * contiguous block.  So when the remote side is contiguous (or the
+ * gaps are small enough to read through), the local side is packed or
+ * unpacked through a bounce buffer and moved in a single operation.
+ * Otherwise every element is issued non-blocking and we wait once, on
+ * the endpoint flush, at the end.
+ */
+
+/* largest bounce buffer for one strided call */
+#define STRIDED_BOUNCE_BYTES (256 * 1024)
+
+/* read the whole span of a strided get if stride is at most this */
+#define STRIDED_SPAN_MAX_STRIDE 4
+
+/*
+ * copy nelems elements of size es between two byte strides
+ */
+static void
+strided_copy(void *dst, ptrdiff_t dst_nb,
+             const void *src, ptrdiff_t src_nb,
+             size_t es, size_t nelems)
+{
+    char *d = (char *) dst;
+    const char *s = (const char *) src;
+    size_t i;
+
+#define STRIDED_COPY_LOOP(_nb)                          \
+    for (i = 0; i < nelems; ++i) {                      \
+        memcpy(d, s, _nb);                              \
+        d += dst_nb;                                    \
+        s += src_nb;                                    \
+    }
+
+    switch (es) {
+    case 1:
+        STRIDED_COPY_LOOP(1);
+        break;
+    case 2:
+        STRIDED_COPY_LOOP(2);
+        break;
+    case 4:
+        STRIDED_COPY_LOOP(4);
+        break;
+    case 8:
+        STRIDED_COPY_LOOP(8);
+        break;
+    case 16:
+        STRIDED_COPY_LOOP(16);
+        break;
+    default:
+        STRIDED_COPY_LOOP(es);
+        break;
+    }
+
+#undef STRIDED_COPY_LOOP
+}
+
+/*
+ * how many elements go through the bounce buffer at once, when each
+ * element takes up "footprint" bytes of it
  */
+inline static size_t
+strided_chunk(size_t footprint, size_t nelems)
+{
+    size_t n = STRIDED_BOUNCE_BYTES / footprint;
+
+    if (n == 0) {
+        n = 1;
+    }
+    return (n < nelems) ? n : nelems;
+}
+
+static void
+strided_ep_flush(shmemc_context_h ch, ucp_ep_h ep, int pe)
+{
+    ucs_status_ptr_t req;
+    ucs_status_t s;
+
+    req = ucp_ep_flush_nb(ep, 0, nb_callback);
+    s = check_wait_for_request(ch, req);
+    shmemu_assert(s == UCS_OK,
+                  "strided transfer to PE %d failed (status: %s)",
+                  pe, ucs_status_string(s));
+}
 
 void
-shmemc_ctx_put_signal(shmem_ctx_t ctx,
-                      void *dest, const void *src,
-                      size_t nbytes,
-                      uint64_t *sig_addr,
-                      uint64_t signal,
-                      int sig_op,
-                      int pe)
+shmemc_ctx_iput(shmem_ctx_t ctx,
+                void *dest, const void *src,
+                size_t es,
+                ptrdiff_t tst, ptrdiff_t sst,
+                size_t nelems, int pe)
 {
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    const ptrdiff_t tst_nb = tst * es;
+    const ptrdiff_t sst_nb = sst * es;
+    const char *sp = (const char *) src;
+    uint64_t r_dest;
+    ucp_rkey_h r_key;
+    ucp_ep_h ep;
+    void *dp;
+    size_t i;
 
-    shmemc_ctx_put(ctx, dest, src, nbytes, pe);
-    shmemc_ctx_fence(ctx);
+    if (nelems == 0) {
+        return;
+        /* NOT REACHED */
+    }
+
+    if ((tst == 1 && sst == 1) || nelems == 1) {
+        shmemc_ctx_put(ctx, dest, src, es * nelems, pe);
+        return;
+        /* NOT REACHED */
+    }
+
+    dp = lookup_direct_addr(ch, (uint64_t) dest, pe);
+    if (dp != NULL) {
+        strided_copy(dp, tst_nb, src, sst_nb, es, nelems);
+        return;
+        /* NOT REACHED */
+    }
+
+    /* contiguous target: pack source, one put per bounce buffer */
+    if (tst == 1) {
+        const size_t chunk = strided_chunk(es, nelems);
+        char *bounce = (char *) malloc(chunk * es);
+
+        if (bounce != NULL) {
+            char *tp = (char *) dest;
+            size_t done = 0;
+
+            while (done < nelems) {
+                const size_t n =
+                    (nelems - done < chunk) ? nelems - done : chunk;
+
+                strided_copy(bounce, es, sp, sst_nb, es, n);
+                shmemc_ctx_put(ctx, tp, bounce, n * es, pe);
+
+                sp += n * sst_nb;
+                tp += n * es;
+                done += n;
+            }
+            free(bounce);
+            return;
+            /* NOT REACHED */
+        }
+        /* else fall through to element-wise */
+    }
+
+    get_remote_key_and_addr(ch, (uint64_t) dest, pe, &r_key, &r_dest);
+    ep = lookup_ucp_ep(ch, pe);
+
+    for (i = 0; i < nelems; ++i) {
+        const ucs_status_t s = ucp_put_nbi(ep, sp, es, r_dest, r_key);
+
+        shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                      "strided put to PE %d failed (status: %s)",
+                      pe, ucs_status_string(s));
+
+        sp += sst_nb;
+        r_dest += tst_nb;
+    }
+
+    strided_ep_flush(ch, ep, pe);
+}
+
+void
+shmemc_ctx_iget(shmem_ctx_t ctx,
+                void *dest, const void *src,
+                size_t es,
+                ptrdiff_t tst, ptrdiff_t sst,
+                size_t nelems, int pe)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+    const ptrdiff_t tst_nb = tst * es;
+    const ptrdiff_t sst_nb = sst * es;
+    char *tp = (char *) dest;
+    uint64_t r_src;
+    ucp_rkey_h r_key;
+    ucp_ep_h ep;
+    void *dp;
+    size_t i;
+
+    if (nelems == 0) {
+        return;
+        /* NOT REACHED */
+    }
+
+    if ((tst == 1 && sst == 1) || nelems == 1) {
+        shmemc_ctx_get(ctx, dest, src, es * nelems, pe);
+        return;
+        /* NOT REACHED */
+    }
+
+    dp = lookup_direct_addr(ch, (uint64_t) src, pe);
+    if (dp != NULL) {
+        strided_copy(dest, tst_nb, dp, sst_nb, es, nelems);
+        return;
+        /* NOT REACHED */
+    }
+
+    /*
+     * contiguous or narrowly-strided source: read the span, then
+     * pick the elements out locally.  Zero or backward strides go
+     * element-wise.
+     */
+    if ((sst >= 1) && (sst <= STRIDED_SPAN_MAX_STRIDE)) {
+        const size_t chunk = strided_chunk(sst_nb, nelems);
+        char *bounce = (char *) malloc((chunk - 1) * sst_nb + es);
+
+        if (bounce != NULL) {
+            const char *sp = (const char *) src;
+            size_t done = 0;
+
+            while (done < nelems) {
+                const size_t n =
+                    (nelems - done < chunk) ? nelems - done : chunk;
+
+                shmemc_ctx_get(ctx, bounce, sp, (n - 1) * sst_nb + es, pe);
+                strided_copy(tp, tst_nb, bounce, sst_nb, es, n);
+
+                sp += n * sst_nb;
+                tp += n * tst_nb;
+                done += n;
+            }
+            free(bounce);
+            return;
+            /* NOT REACHED */
+        }
+        /* else fall through to element-wise */
+    }
+
+    get_remote_key_and_addr(ch, (uint64_t) src, pe, &r_key, &r_src);
+    ep = lookup_ucp_ep(ch, pe);
+
+    for (i = 0; i < nelems; ++i) {
+        const ucs_status_t s = ucp_get_nbi(ep, tp, es, r_src, r_key);
+
+        shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                      "strided get from PE %d failed (status: %s)",
+                      pe, ucs_status_string(s));
+
+        tp += tst_nb;
+        r_src += sst_nb;
+    }
+
+    strided_ep_flush(ch, ep, pe);
+}
+
+/*
+ * puts with signals
+ *
+ * The signal must not land before the data.  Rather than fencing the
+ * whole worker, we flush just the endpoint to the target PE and
+ * update the signal when that flush completes.
+ */
+
+typedef struct signal_post {
+    shmemc_context_h ch;        /* context this is on */
+    ucp_ep_h ep;                /* endpoint to target PE */
+    ucp_rkey_h r_key;           /* rkey for signal on target */
+    uint64_t r_sig;             /* signal address on target */
+    uint64_t signal;            /* value to set/add */
+    int sig_op;                 /* SHMEM_SIGNAL_{SET,ADD} */
+} signal_post_t;
+
+static void
+post_signal(const signal_post_t *spp)
+{
+    ucs_status_ptr_t req;
+    ucs_status_t s;
+
+    switch (spp->sig_op) {
+    case SHMEM_SIGNAL_SET:
+        /* no posted swap in UCX, so fetch into somewhere harmless */
+        req = ucp_atomic_fetch_nb(spp->ep,
+                                  UCP_ATOMIC_FETCH_OP_SWAP,
+                                  spp->signal,
+                                  & spp->ch->signal_scratch,
+                                  sizeof(spp->signal),
+                                  spp->r_sig, spp->r_key,
+                                  nb_callback);
+        if (UCS_PTR_IS_PTR(req)) {
+            ucp_request_free(req); /* quiet will complete it */
+            s = UCS_OK;
+        }
+        else {
+            s = UCS_PTR_STATUS(req);
+        }
+        break;
+    case SHMEM_SIGNAL_ADD:
+        s = ucp_atomic_post(spp->ep,
+                            UCP_ATOMIC_POST_OP_ADD,
+                            spp->signal, sizeof(spp->signal),
+                            spp->r_sig, spp->r_key);
+        break;
+    default:
+        shmemu_fatal("unknown signal operation code %d",
+                     spp->sig_op);
+        /* NOT REACHED */
+        return;
+    }
+
+    shmemu_assert(s == UCS_OK || s == UCS_INPROGRESS,
+                  "signal update failed (status: %s)",
+                  ucs_status_string(s));
+}
+
+inline static void
+signal_done(signal_post_t *spp)
+{
+    __atomic_sub_fetch(& spp->ch->nsignals, 1, __ATOMIC_RELEASE);
+    free(spp);
+}
+
+#ifdef HAVE_UCP_EP_FLUSH_NBX
+static void
+signal_flush_callback(void *req, ucs_status_t status, void *user_data)
+{
+    signal_post_t *spp = (signal_post_t *) user_data;
+
+    NO_WARN_UNUSED(req);
+
+    shmemu_assert(status == UCS_OK,
+                  "endpoint flush before signal failed (status: %s)",
+                  ucs_status_string(status));
+
+    post_signal(spp);
+    signal_done(spp);
+}
+#endif  /* HAVE_UCP_EP_FLUSH_NBX */
+
+/*
+ * wait for this endpoint only, then signal
+ */
+static void
+flush_then_signal(signal_post_t *spp, int pe)
+{
+    ucs_status_ptr_t req;
+    ucs_status_t s;
+
+    req = ucp_ep_flush_nb(spp->ep, 0, nb_callback);
+    s = check_wait_for_request(spp->ch, req);
+    shmemu_assert(s == UCS_OK,
+                  "endpoint flush before signal to PE %d failed: %s",
+                  pe, ucs_status_string(s));
+
+    NO_WARN_UNUSED(pe);
+
+    post_signal(spp);
+    signal_done(spp);
+}
+
+/*
+ * Blocking calls signal before returning: nothing else is guaranteed
+ * to progress this context's worker (waits only progress the default
+ * one).  Non-blocking ones can leave it to the flush callback, since
+ * quiet waits for it.
+ */
+static void
+issue_ordered_signal(shmemc_context_h ch,
+                     uint64_t *sig_addr,
+                     uint64_t signal,
+                     int sig_op,
+                     int pe,
+                     bool nbi)
+{
+    signal_post_t *spp;
+
+    /* data may still be sitting in a coalescing buffer */
+    if (ch->attr.coalesce) {
+        combine_send(ch, pe);
+    }
+
+    spp = (signal_post_t *) malloc(sizeof(*spp));
+    shmemu_assert(spp != NULL,
+                  "can't allocate memory for signal to PE %d", pe);
+
+    spp->ch = ch;
+    spp->ep = lookup_ucp_ep(ch, pe);
+    get_remote_key_and_addr(ch, (uint64_t) sig_addr, pe,
+                            & spp->r_key, & spp->r_sig);
+    spp->signal = signal;
+    spp->sig_op = sig_op;
+
+    __atomic_add_fetch(& ch->nsignals, 1, __ATOMIC_RELAXED);
+
+#ifdef HAVE_UCP_EP_FLUSH_NBX
+    if (nbi) {
+        ucp_request_param_t prm;
+        ucs_status_ptr_t req;
+
+        prm.op_attr_mask =
+            UCP_OP_ATTR_FIELD_CALLBACK |
+            UCP_OP_ATTR_FIELD_USER_DATA;
+        prm.cb.send = signal_flush_callback;
+        prm.user_data = spp;
+
+        req = ucp_ep_flush_nbx(spp->ep, &prm);
+
+        if (req == NULL) {      /* nothing outstanding */
+            post_signal(spp);
+            signal_done(spp);
+        }
+        else if (UCS_PTR_IS_ERR(req)) {
+            shmemu_fatal("endpoint flush before signal to PE %d failed: %s",
+                         pe, ucs_status_string(UCS_PTR_STATUS(req)));
+            /* NOT REACHED */
+        }
+        else {
+            ucp_request_free(req); /* callback still runs */
+        }
+        return;
+        /* NOT REACHED */
+    }
+#else
+    NO_WARN_UNUSED(nbi);
+#endif  /* HAVE_UCP_EP_FLUSH_NBX */
+
+    flush_then_signal(spp, pe);
+}
+
+/*
+ * same-node PEs mapped into our memory: a sequentially-consistent
+ * atomic orders the signal after the copied data
+ */
+inline static bool
+direct_put_signal(shmemc_context_h ch,
+                  void *dest, const void *src,
+                  size_t nbytes,
+                  uint64_t *sig_addr,
+                  uint64_t signal,
+                  int sig_op,
+                  int pe)
+{
+    void *dp = lookup_direct_addr(ch, (uint64_t) dest, pe);
+    uint64_t *sp;
+
+    if (dp == NULL) {
+        return false;
+        /* NOT REACHED */
+    }
+
+    sp = (uint64_t *) lookup_direct_addr(ch, (uint64_t) sig_addr, pe);
+    if (sp == NULL) {
+        return false;
+        /* NOT REACHED */
+    }
+
+    memcpy(dp, src, nbytes);
 
     switch (sig_op) {
     case SHMEM_SIGNAL_SET:
-        shmemc_ctx_set(ctx,
-                       sig_addr, sizeof(*sig_addr),
-                       &signal, sizeof(signal),
-                       pe);
+        __atomic_store_n(sp, signal, __ATOMIC_SEQ_CST);
         break;
     case SHMEM_SIGNAL_ADD:
-        shmemc_ctx_add(ctx, sig_addr, &signal, sizeof(signal), pe);
+        __atomic_add_fetch(sp, signal, __ATOMIC_SEQ_CST);
         break;
     default:
         shmemu_fatal("unknown signal operation code %d",
@@ -824,10 +2574,38 @@ shmemc_ctx_put_signal(shmem_ctx_t ctx,
         /* NOT REACHED */
         break;
     }
+
+    return true;
+}
+
+/*
+ * blocking: returns once the source buffer can be reused
+ */
+
+void
+shmemc_ctx_put_signal(shmem_ctx_t ctx,
+                      void *dest, const void *src,
+                      size_t nbytes,
+                      uint64_t *sig_addr,
+                      uint64_t signal,
+                      int sig_op,
+                      int pe)
+{
+    shmemc_context_h ch = (shmemc_context_h) ctx;
+
+    if (direct_put_signal(ch, dest, src, nbytes,
+                          sig_addr, signal, sig_op, pe)) {
+        return;
+        /* NOT REACHED */
+    }
+
+    shmemc_ctx_put(ctx, dest, src, nbytes, pe);
+
+    issue_ordered_signal(ch, sig_addr, signal, sig_op, pe, false);
 }
 
 /*
- * TODO HACK1: just use blocking implemetntion for testing
+ * non-blocking: completed by quiet
  */
 
 void
@@ -839,24 +2617,15 @@ shmemc_ctx_put_signal_nbi(shmem_ctx_t ctx,
                           int sig_op,
                           int pe)
 {
+    shmemc_context_h ch = (shmemc_context_h) ctx;
 
-    shmemc_ctx_put(ctx, dest, src, nbytes, pe);
-    shmemc_ctx_fence(ctx);
-
-    switch (sig_op) {
-    case SHMEM_SIGNAL_SET:
-        shmemc_ctx_set(ctx,
-                       sig_addr, sizeof(*sig_addr),
-                       &signal, sizeof(signal),
-                       pe);
-        break;
-    case SHMEM_SIGNAL_ADD:
-        shmemc_ctx_add(ctx, sig_addr, &signal, sizeof(signal), pe);
-        break;
-    default:
-        shmemu_fatal("unknown signal operation code %d",
-                     sig_op);
+    if (direct_put_signal(ch, dest, src, nbytes,
+                          sig_addr, signal, sig_op, pe)) {
+        return;
         /* NOT REACHED */
-        break;
     }
+
+    shmemc_ctx_put_nbi(ctx, dest, src, nbytes, pe);
+
+    issue_ordered_signal(ch, sig_addr, signal, sig_op, pe, true);
 }
@@ -43,6 +43,8 @@ shmemc_ucx_context_progress(shmemc_context_h ch)
         /* NOT REACHED */
     }
 
+    shmemc_ucx_amo_handlers_init(ch);
+
     return 0;
 }
 
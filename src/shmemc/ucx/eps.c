@@ -9,6 +9,7 @@
 #include "shmemc.h"
 #include "shmemu.h"
 #include "ucx/api.h"
+#include "pmi_client.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +36,34 @@ void
 shmemc_ucx_deallocate_eps_table(shmemc_context_h ch)
 {
     free(ch->eps);
+
+    free(ch->dirty.flags);
+    free(ch->dirty.pes);
+    free(ch->dirty.reqs);
+}
+
+/*
+ * record of which endpoints have been used since the last quiet
+ */
+
+inline static void
+allocate_dirty_set(shmemc_context_h ch)
+{
+    ep_dirty_set_t *dsp = & ch->dirty;
+
+    dsp->flags = (bool *) calloc(proc.nranks, sizeof(*(dsp->flags)));
+    dsp->pes = (int *) malloc(proc.nranks * sizeof(*(dsp->pes)));
+    dsp->reqs = (ucs_status_ptr_t *)
+        malloc(proc.nranks * sizeof(*(dsp->reqs)));
+    shmemu_assert((dsp->flags != NULL) &&
+                  (dsp->pes != NULL) &&
+                  (dsp->reqs != NULL),
+                  "can't allocate endpoint tracking "
+                  "for context %lu: %s",
+                  ch->id,
+                  strerror(errno));
+
+    dsp->npes = 0;
 }
 
 /*
@@ -123,17 +152,140 @@ shmemc_ucx_disconnect_all_eps(shmemc_context_h ch)
     free(req);
 }
 
+/*
+ * if PE is on this node and UCX can map its memory here, remember
+ * where each region appears so we can load/store directly
+ */
+
+#ifdef HAVE_UCP_RKEY_PTR
+
+inline static bool
+is_node_peer(int pe)
+{
+    int i;
+
+    for (i = 0; i < proc.npeers; ++i) {
+        if (proc.peers[i] == pe) {
+            return true;
+            /* NOT REACHED */
+        }
+    }
+
+    return false;
+}
+
+/*
+ * globals, and all heaps if aligned (at build time, or if start-up
+ * could place them), are at the same address everywhere
+ */
+inline static uint64_t
+remote_region_base(size_t r, int pe)
+{
+#ifdef ENABLE_ALIGNED_ADDRESSES
+    NO_WARN_UNUSED(pe);
+
+    return proc.comms.regions[r].minfo[proc.rank].base;
+#else
+    const int which = proc.comms.regions[r].aligned ? proc.rank : pe;
+
+    return proc.comms.regions[r].minfo[which].base;
+#endif  /* ENABLE_ALIGNED_ADDRESSES */
+}
+
+inline static void
+map_direct_region(shmemc_context_h ch, size_t r, int pe, ucp_rkey_h rkey)
+{
+    mem_access_t *map = & ch->racc[r].rinfo[pe];
+    ucs_status_t s;
+
+    if (pe == proc.rank) {
+        map->mapped =
+            (void *) proc.comms.regions[r].minfo[proc.rank].base;
+        return;
+        /* NOT REACHED */
+    }
+
+    s = ucp_rkey_ptr(rkey, remote_region_base(r, pe),
+                     &map->mapped);
+    if (s != UCS_OK) {
+        map->mapped = NULL;
+
+        logger(LOG_CONTEXTS,
+               "context #%lu: no direct access to region %lu on PE %d",
+               ch->id, (unsigned long) r, pe);
+    }
+}
+
+inline static void
+map_direct_access(shmemc_context_h ch, size_t nregions, int pe)
+{
+    size_t r;
+
+    for (r = 0; r < nregions; ++r) {
+        map_direct_region(ch, r, pe, ch->racc[r].rinfo[pe].rkey);
+    }
+}
+
+#endif  /* HAVE_UCP_RKEY_PTR */
+
+/*
+ * serialize connection set-up on a context
+ */
+
+inline static void
+connect_lock(shmemc_context_h ch)
+{
+    while (__atomic_exchange_n(& ch->connect_lock, 1, __ATOMIC_ACQUIRE)) {
+        /* spin */ ;
+    }
+}
+
+inline static void
+connect_unlock(shmemc_context_h ch)
+{
+    __atomic_store_n(& ch->connect_lock, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * access info for region R on all PEs, created if the region
+ * appeared after the context did.  Called with the connect lock held.
+ */
+
+inline static mem_access_t *
+region_access(shmemc_context_h ch, size_t r)
+{
+    mem_access_t *rinfo = ch->racc[r].rinfo;
+
+    if (rinfo == NULL) {
+        rinfo = (mem_access_t *) calloc(proc.nranks, sizeof(*rinfo));
+        shmemu_assert(rinfo != NULL,
+                      "can't allocate remote access info "
+                      "for memory region %lu: %s",
+                      (unsigned long) r,
+                      strerror(errno));
+
+        __atomic_store_n(& ch->racc[r].rinfo, rinfo, __ATOMIC_RELEASE);
+    }
+
+    return rinfo;
+}
+
+/*
+ * Set up a context's tables for remote access.  Endpoints and rkeys
+ * are filled in by shmemc_ucx_connect_pe() when a PE is first used.
+ */
+
 void
 shmemc_ucx_make_eps(shmemc_context_h ch)
 {
-    ucp_ep_params_t epm;
-    ucs_status_t s;
     size_t r;
-    int pe;
 
-    /* allocate remote access fields */
+    /*
+     * allocate remote access fields, with room for regions the heap
+     * might grow by later
+     */
 
-    ch->racc = (mem_region_access_t *) calloc(proc.comms.nregions,
+    ch->racc = (mem_region_access_t *) calloc(proc.comms.maxregions,
                                               sizeof(mem_region_access_t));
     shmemu_assert(ch->racc != NULL,
                   "can't allocate memory for remote access rkeys");
@@ -155,33 +307,135 @@ shmemc_ucx_make_eps(shmemc_context_h ch)
                   ch->id,
                   strerror(errno));
 
-    /* create endpoints and unpack rkeys onto them */
+    ch->connect_lock = 0;
+
+    allocate_dirty_set(ch);
+}
+
+/*
+ * Create endpoint to PE and unpack rkeys onto it.  Threads sharing a
+ * context can race to do this, so it's serialized and the endpoint
+ * is published last: a non-NULL endpoint means everything's ready.
+ */
+
+void
+shmemc_ucx_connect_pe(shmemc_context_h ch, int pe)
+{
+    const size_t nregions =
+        __atomic_load_n(& proc.comms.nregions, __ATOMIC_ACQUIRE);
+    ucp_ep_params_t epm;
+    ucp_ep_h ep;
+    ucs_status_t s;
+    size_t r;
+
+    connect_lock(ch);
+
+    if (ch->eps[pe] != NULL) {  /* someone else got here first */
+        connect_unlock(ch);
+        return;
+        /* NOT REACHED */
+    }
+
+    /* in lazy bootstrap, first contact with PE */
+    shmemc_pmi_fetch_peer(pe);
 
     epm.field_mask = UCP_EP_PARAM_FIELD_REMOTE_ADDRESS;
+    epm.address = (ucp_address_t *) proc.comms.xchg_wrkr_info[pe].buf;
+
+    s = ucp_ep_create(ch->w, &epm, &ep);
+    shmemu_assert(s == UCS_OK,
+                  "Unable to create remote endpoint for PE %d: %s",
+                  pe, ucs_status_string(s)
+                  );
+
+    for (r = 0; r < nregions; ++r) {
+        s = ucp_ep_rkey_unpack(ep,
+                               proc.comms.orks[r].rkeys[pe].data,
+                               & region_access(ch, r)[pe].rkey
+                               );
+        shmemu_assert(s == UCS_OK,
+                      "can't unpack remote rkey "
+                      "for memory region %lu, PE %d: %s",
+                      (unsigned long) r, pe,
+                      ucs_status_string(s));
+    }
 
-    for (pe = 0; pe < proc.nranks; ++pe) {
+#ifdef HAVE_UCP_RKEY_PTR
+    if (proc.env.shared_direct && is_node_peer(pe)) {
+        map_direct_access(ch, nregions, pe);
+    }
+#endif  /* HAVE_UCP_RKEY_PTR */
 
-        epm.address = (ucp_address_t *) proc.comms.xchg_wrkr_info[pe].buf;
+    logger(LOG_CONTEXTS, "context #%lu: connected to PE %d", ch->id, pe);
 
-        s = ucp_ep_create(ch->w, &epm, & ch->eps[pe]);
+    __atomic_store_n(& ch->eps[pe], ep, __ATOMIC_RELEASE);
+    connect_unlock(ch);
+}
+
+/*
+ * Region R was added by heap growth after this context connected to
+ * PE, unpack its rkey now.  Returns the access info.
+ */
 
+const mem_access_t *
+shmemc_ucx_connect_region(shmemc_context_h ch, size_t r, int pe)
+{
+    mem_access_t *rinfo;
+    ucs_status_t s;
+
+    connect_lock(ch);
+
+    rinfo = region_access(ch, r);
+
+    if (rinfo[pe].rkey == NULL) {
+        ucp_rkey_h rkey;
+
+        s = ucp_ep_rkey_unpack(ch->eps[pe],
+                               proc.comms.orks[r].rkeys[pe].data,
+                               &rkey
+                               );
         shmemu_assert(s == UCS_OK,
-                      "Unable to create remote endpoints for PE %d: %s",
-                      pe, ucs_status_string(s)
-                      );
-
-        for (r = 0; r < proc.comms.nregions; ++r) {
-            s = ucp_ep_rkey_unpack(ch->eps[pe],
-                                   proc.comms.orks[r].rkeys[pe].data,
-                                   & ch->racc[r].rinfo[pe].rkey
-                                   );
-            shmemu_assert(s == UCS_OK,
-                          "can't unpack remote rkey "
-                          "for memory region %lu, PE %d: %s",
-                          (unsigned long) r, pe,
-                          ucs_status_string(s));
+                      "can't unpack remote rkey "
+                      "for memory region %lu, PE %d: %s",
+                      (unsigned long) r, pe,
+                      ucs_status_string(s));
+#ifdef HAVE_UCP_RKEY_PTR
+        if (proc.env.shared_direct && is_node_peer(pe)) {
+            map_direct_region(ch, r, pe, rkey);
         }
+#endif  /* HAVE_UCP_RKEY_PTR */
+
+        /* mapping before rkey, readers check the rkey */
+        __atomic_store_n(& rinfo[pe].rkey, rkey, __ATOMIC_RELEASE);
     }
+
+    connect_unlock(ch);
+
+    return & rinfo[pe];
+}
+
+/*
+ * how many PEs has this context actually talked to?
+ */
+
+int
+shmemc_ucx_connected_pes(shmemc_context_h ch)
+{
+    int n = 0;
+    int pe;
+
+    if (ch->eps == NULL) {
+        return 0;
+        /* NOT REACHED */
+    }
+
+    for (pe = 0; pe < proc.nranks; ++pe) {
+        if (ch->eps[pe] != NULL) {
+            ++n;
+        }
+    }
+
+    return n;
 }
 
 ucs_status_t
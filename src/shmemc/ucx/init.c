@@ -10,6 +10,7 @@
 #include "state.h"
 #include "globalexit.h"
 #include "readenv.h"
+#include "pmi_client.h"
 
 #include "allocator/memalloc.h"
 
@@ -18,6 +19,10 @@
 #include <stdlib.h>             /* getenv */
 #include <string.h>
 #include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 
 #include <ucp/api/ucp.h>
 
@@ -39,8 +44,10 @@ deallocate_xworkers_table(void)
     int pe;
 
     /* clean up worker exchange */
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        free(proc.comms.xchg_wrkr_info[pe].buf);
+    if (! proc.comms.boot_shared) {
+        for (pe = 0; pe < proc.nranks; ++pe) {
+            free(proc.comms.xchg_wrkr_info[pe].buf);
+        }
     }
     free(proc.comms.xchg_wrkr_info);
 }
@@ -121,9 +128,36 @@ static mem_info_t *globals;
 extern char data_start;
 extern char end;
 
+/*
+ * the linker provides these if the program put anything in the
+ * SHMEM_SYMMETRIC section
+ */
+extern char __start_shmem_symmetric[] __attribute__((weak));
+extern char __stop_shmem_symmetric[] __attribute__((weak));
+
 inline static void
 get_globals_address_range(uint64_t *base_p, uint64_t *end_p)
 {
+    if (proc.env.globals_section) {
+        const uint64_t sb = (uint64_t) __start_shmem_symmetric;
+        const uint64_t se = (uint64_t) __stop_shmem_symmetric;
+
+        if ((sb != 0) && (se > sb)) {
+            *base_p = sb;
+            *end_p  = se;
+
+            logger(LOG_INIT,
+                   "registering %lu bytes of SHMEM_SYMMETRIC globals",
+                   (unsigned long) (se - sb));
+            return;
+            /* NOT REACHED */
+        }
+
+        logger(LOG_INIT,
+               "no SHMEM_SYMMETRIC globals found, "
+               "registering all data and BSS");
+    }
+
     *base_p = (uint64_t) &data_start;
     *end_p  = (uint64_t) &end;
 }
@@ -174,28 +208,611 @@ deregister_globals(void)
  * multiple symmetric heaps
  */
 
+/*
+ * NUMA placement of heap pages.  Uses the system calls directly so
+ * we don't need libnuma.
+ */
+
+#ifndef MPOL_PREFERRED
+# define MPOL_PREFERRED 1
+#endif  /* MPOL_PREFERRED */
+#ifndef MPOL_BIND
+# define MPOL_BIND 2
+#endif  /* MPOL_BIND */
+#ifndef MPOL_INTERLEAVE
+# define MPOL_INTERLEAVE 3
+#endif  /* MPOL_INTERLEAVE */
+#ifndef MPOL_F_MEMS_ALLOWED
+# define MPOL_F_MEMS_ALLOWED (1 << 2)
+#endif  /* MPOL_F_MEMS_ALLOWED */
+
+#define NODEMASK_LONGS 16       /* up to 1024 nodes */
+#define BITS_PER_LONG  (8 * sizeof(unsigned long))
+#define NODEMASK_BITS  (NODEMASK_LONGS * BITS_PER_LONG)
+
+inline static bool
+heap_placement_wanted(size_t heapno)
+{
+    return
+        (proc.env.heaps.numa[heapno] >= 0) ||
+        (proc.env.heap_numa != SHMEMC_NUMA_NONE);
+}
+
+/*
+ * Has to happen before anything touches the pages.  A node given for
+ * the heap itself wins over SHMEM_HEAP_NUMA.  "local" only prefers
+ * the node, as the PE might not be pinned to it.
+ */
+
+static void
+bind_heap_pages(size_t heapno, void *p, size_t len)
+{
+    const unsigned long hn = (unsigned long) heapno; /* printing */
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy) && defined(SYS_getcpu)
+    unsigned long mask[NODEMASK_LONGS];
+    int node = proc.env.heaps.numa[heapno];
+    int mode;
+
+    memset(mask, 0, sizeof(mask));
+
+    if (node >= 0) {
+        mode = MPOL_BIND;
+    }
+    else if (proc.env.heap_numa == SHMEMC_NUMA_LOCAL) {
+        unsigned cpu, here;
+
+        if (syscall(SYS_getcpu, &cpu, &here, NULL) != 0) {
+            shmemu_warn("can't find local NUMA node for "
+                        "symmetric heap #%lu (%s)",
+                        hn, strerror(errno));
+            return;
+            /* NOT REACHED */
+        }
+        node = (int) here;
+        mode = MPOL_PREFERRED;
+    }
+    else {
+        /* all the nodes we're allowed */
+        if (syscall(SYS_get_mempolicy, NULL, mask, NODEMASK_BITS + 1,
+                    NULL, MPOL_F_MEMS_ALLOWED) != 0) {
+            shmemu_warn("can't find NUMA nodes to interleave "
+                        "symmetric heap #%lu over (%s)",
+                        hn, strerror(errno));
+            return;
+            /* NOT REACHED */
+        }
+        mode = MPOL_INTERLEAVE;
+    }
+
+    if (node >= 0) {
+        if ((size_t) node >= NODEMASK_BITS) {
+            shmemu_warn("NUMA node %d out of range for symmetric heap #%lu",
+                        node, hn);
+            return;
+            /* NOT REACHED */
+        }
+        mask[node / BITS_PER_LONG] |= 1UL << (node % BITS_PER_LONG);
+    }
+
+    /* maxnode is one more than the number of bits, per the kernel */
+    if (syscall(SYS_mbind, p, len, mode, mask, NODEMASK_BITS + 1, 0) != 0) {
+        shmemu_warn("can't set NUMA placement of symmetric heap #%lu (%s)",
+                    hn, strerror(errno));
+        return;
+        /* NOT REACHED */
+    }
+
+    if (node >= 0) {
+        logger(LOG_INIT,
+               "symmetric heap #%lu %s NUMA node %d",
+               hn,
+               (mode == MPOL_BIND) ? "bound to" : "prefers",
+               node);
+    }
+    else {
+        logger(LOG_INIT,
+               "symmetric heap #%lu interleaved over NUMA nodes",
+               hn);
+    }
+#else
+    NO_WARN_UNUSED(p);
+    NO_WARN_UNUSED(len);
+
+    shmemu_warn("NUMA placement not supported here, "
+                "ignored for symmetric heap #%lu",
+                hn);
+#endif  /* SYS_mbind && SYS_get_mempolicy && SYS_getcpu */
+}
+
+#define THP_PAGESIZE (2UL * 1024 * 1024) /* x86_64, aarch64 w/ 4K pages */
+
+/*
+ * the page size heap HEAPNO asked for
+ */
+inline static size_t
+heap_page_size(size_t heapno)
+{
+    const size_t want = proc.env.heaps.pagesize[heapno];
+
+    if (want == 0) {
+        return (size_t) sysconf(_SC_PAGESIZE);
+    }
+    else if (want == SHMEMC_PAGESIZE_THP) {
+        return THP_PAGESIZE;
+    }
+    else {
+        return want;
+    }
+}
+
+inline static size_t
+round_up(size_t n, size_t to)
+{
+    return (n + to - 1) & ~(to - 1);
+}
+
+/*
+ * Identical heap addresses: lay the heaps out back to back in one
+ * span, agree on an address where every PE can reserve that span,
+ * then map each heap into its slot.  Translating heap addresses is
+ * then a no-op, as with aligned addresses, but without a special
+ * build or turning off ASR.  If any PE can't get the span, heaps go
+ * wherever they land, as usual.
+ */
+
+static uint64_t same_va_base = 0; /* agreed span, or 0 if none */
+static size_t same_va_len;
+static size_t *same_va_offset = NULL; /* where each heap goes in span */
+
+#ifndef ENABLE_ALIGNED_ADDRESSES
+
+#ifndef MAP_FIXED_NOREPLACE
+# define MAP_FIXED_NOREPLACE 0  /* just a hint then, checked below */
+#endif  /* MAP_FIXED_NOREPLACE */
+
+#define SAME_VA_TRIES 4         /* proposals before giving up */
+
+static const int reserve_flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+
+/*
+ * each heap starts on its own page boundary, span is aligned for the
+ * largest page
+ */
+static size_t
+same_va_layout(size_t *align_p)
+{
+    size_t align = (size_t) sysconf(_SC_PAGESIZE);
+    size_t off = 0;
+    size_t h;
+
+    same_va_offset = (size_t *) calloc(proc.env.heaps.nheaps,
+                                       sizeof(*same_va_offset));
+    shmemu_assert(same_va_offset != NULL,
+                  "can't allocate memory for symmetric heap layout");
+
+    for (h = 0; h < proc.env.heaps.nheaps; ++h) {
+        const size_t ps = heap_page_size(h);
+
+        off = round_up(off, ps);
+        same_va_offset[h] = off;
+        off += round_up(proc.env.heaps.heapsize[h], ps);
+
+        if (ps > align) {
+            align = ps;
+        }
+    }
+
+    *align_p = align;
+    return off;
+}
+
+/*
+ * PE 0 lets the kernel pick somewhere free and suggests that
+ */
+static void *
+same_va_propose(size_t len, size_t align)
+{
+    char *p;
+    char *a;
+
+    p = (char *) mmap(NULL, len + align, PROT_NONE, reserve_flags, -1, 0);
+    if (p == (char *) MAP_FAILED) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    /* trim the slack either side of the aligned span */
+    a = (char *) round_up((size_t) p, align);
+    if (a > p) {
+        (void) munmap(p, a - p);
+    }
+    (void) munmap(a + len, align - (a - p));
+
+    return a;
+}
+
+/*
+ * everyone else tries to reserve the same span, without clobbering
+ * anything already there
+ */
+static void *
+same_va_claim(uint64_t where, size_t len)
+{
+    void *want = (void *) where;
+    void *p;
+
+    p = mmap(want, len, PROT_NONE, reserve_flags | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p == MAP_FAILED) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    /* older kernels treat the address as a hint */
+    if (p != want) {
+        (void) munmap(p, len);
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    return p;
+}
+
+/*
+ * Collective, over PMI as nothing else is up yet.  PE 0 reserves all
+ * its candidate spans up front (holding each one so the next is
+ * different) and publishes them.  Everyone claims what they can and
+ * publishes one vote, a bit per candidate.  The second fence collects
+ * the votes, so every PE folds the same answer locally and no-one has
+ * to announce an outcome: two fences however many candidates fail.
+ */
+static void
+same_va_negotiate(void)
+{
+    void *mine[SAME_VA_TRIES];
+    uint64_t where[SAME_VA_TRIES];
+    uint64_t votes = 0;
+    char propose[16];
+    size_t align;
+    int pick = -1;
+    int t;
+    int pe;
+
+    same_va_len = same_va_layout(&align);
+
+    if (proc.rank == 0) {
+        for (t = 0; t < SAME_VA_TRIES; ++t) {
+            mine[t] = same_va_propose(same_va_len, align);
+
+            snprintf(propose, sizeof(propose), "svp:%d", t);
+            shmemc_pmi_publish_value(propose, (uint64_t) mine[t]);
+        }
+    }
+    shmemc_pmi_barrier_all(true);
+
+    for (t = 0; t < SAME_VA_TRIES; ++t) {
+        if (proc.rank == 0) {
+            where[t] = (uint64_t) mine[t];
+        }
+        else {
+            snprintf(propose, sizeof(propose), "svp:%d", t);
+            where[t] = shmemc_pmi_fetch_value(0, propose);
+
+            mine[t] =
+                (where[t] != 0) ? same_va_claim(where[t], same_va_len) : NULL;
+        }
+
+        if (mine[t] != NULL) {
+            votes |= (uint64_t) 1 << t;
+        }
+    }
+
+    shmemc_pmi_publish_value("svv", votes);
+    shmemc_pmi_barrier_all(true);
+
+    /* a candidate survives only if every PE got it */
+    for (pe = 0; (votes != 0) && (pe < proc.nranks); ++pe) {
+        if (pe != proc.rank) {
+            votes &= shmemc_pmi_fetch_value(pe, "svv");
+        }
+    }
+
+    for (t = 0; t < SAME_VA_TRIES; ++t) {
+        if ((pick < 0) && (votes & ((uint64_t) 1 << t))) {
+            pick = t;
+            same_va_base = where[t];
+        }
+        else if (mine[t] != NULL) {
+            (void) munmap(mine[t], same_va_len);
+        }
+    }
+
+    if (same_va_base != 0) {
+        logger(LOG_INIT,
+               "symmetric heaps at 0x%lx (%lu bytes) on all PEs",
+               (unsigned long) same_va_base,
+               (unsigned long) same_va_len);
+    }
+    else {
+        logger(LOG_INIT,
+               "can't put symmetric heaps at the same address on all PEs, "
+               "translating addresses instead");
+        free(same_va_offset);
+        same_va_offset = NULL;
+    }
+}
+
+#endif  /* ! ENABLE_ALIGNED_ADDRESSES */
+
+/*
+ * where heap HEAPNO has to go, or NULL if anywhere
+ */
+inline static void *
+same_va_slot(size_t heapno)
+{
+    if (same_va_base == 0) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    return (void *) (same_va_base + same_va_offset[heapno]);
+}
+
+/*
+ * drop the reservation, including any gaps between heaps
+ */
 inline static void
-register_symmetric_heap(size_t heapno, mem_info_t *mip)
+same_va_release(void)
+{
+    if (same_va_base != 0) {
+        (void) munmap((void *) same_va_base, same_va_len);
+        same_va_base = 0;
+    }
+    free(same_va_offset);
+    same_va_offset = NULL;
+}
+
+/*
+ * If huge pages or NUMA placement were asked for, or the heap has to
+ * go at WHERE, map the heap ourselves.  Returns NULL if UCX should
+ * allocate it (not asked for, or couldn't get them), otherwise the
+ * mapping, with *len_p rounded up to a whole number of pages.
+ */
+
+inline static void *
+map_heap_pages(size_t heapno, void *where,
+               size_t *len_p, size_t *pagesize_p)
+{
+    const size_t want = proc.env.heaps.pagesize[heapno];
+    const bool place = heap_placement_wanted(heapno);
+    const size_t sys_ps = (size_t) sysconf(_SC_PAGESIZE);
+    const unsigned long hn = (unsigned long) heapno; /* printing */
+    const int plain_flags =
+        MAP_PRIVATE | MAP_ANONYMOUS | ((where != NULL) ? MAP_FIXED : 0);
+    size_t ps;
+    size_t len;
+    int flags = plain_flags;
+    void *p;
+
+    *pagesize_p = 0;
+
+    if ((want == 0) && (! place) && (where == NULL)) {
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    ps = heap_page_size(heapno);
+    len = round_up(*len_p, ps);
+
+    if ((want != 0) && (want != SHMEMC_PAGESIZE_THP)) {
+#ifdef MAP_HUGETLB
+        flags |= MAP_HUGETLB;
+# ifdef MAP_HUGE_SHIFT
+        flags |= (__builtin_ctzl(ps) << MAP_HUGE_SHIFT);
+# endif  /* MAP_HUGE_SHIFT */
+#else
+        shmemu_warn("huge pages not supported here, "
+                    "using default pages for symmetric heap #%lu",
+                    hn);
+        return NULL;
+        /* NOT REACHED */
+#endif  /* MAP_HUGETLB */
+    }
+
+    /* with WHERE, this replaces our reservation of the slot */
+    p = mmap(where, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED) {
+        shmemu_warn("can't get %lu-byte pages for symmetric heap #%lu (%s), "
+                    "using default pages",
+                    (unsigned long) ps, hn, strerror(errno));
+        if ((! place) && (where == NULL)) {
+            return NULL;
+            /* NOT REACHED */
+        }
+
+        /* still want the placement */
+        ps = sys_ps;
+        len = round_up(*len_p, ps);
+        p = mmap(where, len, PROT_READ | PROT_WRITE, plain_flags, -1, 0);
+        if (p == MAP_FAILED) {
+            if (where != NULL) {
+                shmemu_fatal("can't map symmetric heap #%lu "
+                             "at its agreed address %p (%s)",
+                             hn, where, strerror(errno));
+                /* NOT REACHED */
+            }
+            shmemu_warn("can't map symmetric heap #%lu (%s), "
+                        "leaving it to UCX",
+                        hn, strerror(errno));
+            return NULL;
+            /* NOT REACHED */
+        }
+    }
+    else if (want == SHMEMC_PAGESIZE_THP) {
+#ifdef MADV_HUGEPAGE
+        if (madvise(p, len, MADV_HUGEPAGE) != 0) {
+            shmemu_warn("transparent huge pages not available "
+                        "for symmetric heap #%lu (%s)",
+                        hn, strerror(errno));
+            ps = sys_ps;
+        }
+#else
+        ps = sys_ps;
+#endif  /* MADV_HUGEPAGE */
+    }
+
+    if (place) {
+        bind_heap_pages(heapno, p, len);
+    }
+
+    *len_p = len;
+    *pagesize_p = ps;
+
+    return p;
+}
+
+/*
+ * Touch every page of a heap up front, so page faults happen here
+ * and not in the program's first timed loop.  Work is split over
+ * SHMEM_HEAP_PREFAULT threads.
+ */
+
+typedef struct prefault_range {
+    volatile char *start;
+    size_t len;
+    size_t step;
+    bool threaded;              /* did a helper thread get it? */
+} prefault_range_t;
+
+static void *
+prefault_range(void *arg)
+{
+    const prefault_range_t *rp = (const prefault_range_t *) arg;
+    size_t off;
+
+    for (off = 0; off < rp->len; off += rp->step) {
+        rp->start[off] = 0;     /* fresh anonymous memory, already 0 */
+    }
+
+    return NULL;
+}
+
+static void
+prefault_heap(size_t heapno, void *p, size_t len, size_t pagesize)
+{
+    const size_t sys_ps = (size_t) sysconf(_SC_PAGESIZE);
+    size_t nthreads = proc.env.heap_prefault;
+    prefault_range_t *ranges;
+    threadwrap_thread_t *threads;
+    size_t step;
+    size_t npages;
+    size_t chunk;
+    size_t t;
+    int s;
+
+    /* THP might not come through, so fault at base page granularity */
+    step = sys_ps;
+    if ((pagesize > sys_ps) &&
+        (proc.env.heaps.pagesize[heapno] != SHMEMC_PAGESIZE_THP)) {
+        step = pagesize;
+    }
+
+    npages = (len + step - 1) / step;
+    if (nthreads > npages) {
+        nthreads = npages;
+    }
+    if (nthreads == 0) {
+        return;
+        /* NOT REACHED */
+    }
+    chunk = ((npages + nthreads - 1) / nthreads) * step;
+
+    ranges = (prefault_range_t *) malloc(nthreads * sizeof(*ranges));
+    threads = (threadwrap_thread_t *) malloc(nthreads * sizeof(*threads));
+    shmemu_assert((ranges != NULL) && (threads != NULL),
+                  "can't allocate memory to pre-fault symmetric heap #%lu",
+                  (unsigned long) heapno);
+
+    for (t = 0; t < nthreads; ++t) {
+        const size_t off = t * chunk;
+
+        ranges[t].start = (volatile char *) p + off;
+        ranges[t].len   = (off >= len) ? 0 : (len - off);
+        if (ranges[t].len > chunk) {
+            ranges[t].len = chunk;
+        }
+        ranges[t].step  = step;
+        ranges[t].threaded = false;
+    }
+
+    /* we do the first range ourselves */
+    for (t = 1; t < nthreads; ++t) {
+        s = threadwrap_thread_create(&threads[t], prefault_range,
+                                     &ranges[t]);
+        if (s == 0) {
+            ranges[t].threaded = true;
+        }
+        else {
+            /* no more threads, just do it here */
+            (void) prefault_range(&ranges[t]);
+        }
+    }
+
+    (void) prefault_range(&ranges[0]);
+
+    for (t = 1; t < nthreads; ++t) {
+        if (ranges[t].threaded) {
+            (void) threadwrap_thread_join(threads[t], NULL);
+        }
+    }
+
+    logger(LOG_INIT,
+           "pre-faulted %lu pages of symmetric heap #%lu with %lu thread%s",
+           (unsigned long) npages, (unsigned long) heapno,
+           (unsigned long) nthreads, (nthreads == 1) ? "" : "s");
+
+    free(threads);
+    free(ranges);
+}
+
+/*
+ * map and register LEN bytes for heap HEAPNO, using that heap's page
+ * size and NUMA settings, at WHERE if not NULL
+ */
+
+static void
+map_heap_region(size_t heapno, void *where, size_t len, mem_info_t *mip)
 {
     ucs_status_t s;
     ucp_mem_map_params_t mp;
     ucp_mem_attr_t attr;
     const unsigned long hn = (unsigned long) heapno; /* printing */
+    void *p;
 
-    shmemu_assert(proc.env.heaps.heapsize[heapno] > 0,
-                  "Cannot register empty symmetric heap #%lu",
-                  hn);
+    p = map_heap_pages(heapno, where, &len, &mip->pagesize);
+    mip->own_alloc = (p != NULL);
+
+    /* fault our own pages in before registration gets to them */
+    if (mip->own_alloc && (proc.env.heap_prefault > 0)) {
+        prefault_heap(heapno, p, len, mip->pagesize);
+    }
 
     /* now register it with UCX */
     mp.field_mask =
         UCP_MEM_MAP_PARAM_FIELD_LENGTH |
         UCP_MEM_MAP_PARAM_FIELD_FLAGS;
 
-    mp.length = proc.env.heaps.heapsize[heapno];
+    mp.length = len;
 
-    mp.flags =
-        UCP_MEM_MAP_NONBLOCK |
-        UCP_MEM_MAP_ALLOCATE;
+    if (mip->own_alloc) {
+        mp.field_mask |= UCP_MEM_MAP_PARAM_FIELD_ADDRESS;
+        mp.address = p;
+        mp.flags = UCP_MEM_MAP_NONBLOCK;
+    }
+    else {
+        mp.flags =
+            UCP_MEM_MAP_NONBLOCK |
+            UCP_MEM_MAP_ALLOCATE;
+    }
 
     s = ucp_mem_map(proc.comms.ucx_ctxt, &mp, &mip->mh);
     shmemu_assert(s == UCS_OK,
@@ -224,8 +841,25 @@ register_symmetric_heap(size_t heapno, mem_info_t *mip)
     mip->end  = mip->base + attr.length;
     mip->len  = attr.length;
 
-    /* initialize the heap allocator */
-    shmema_init((void *) mip->base, mip->len);
+    if ((! mip->own_alloc) && (proc.env.heap_prefault > 0)) {
+        prefault_heap(heapno, attr.address, attr.length, 0);
+    }
+}
+
+inline static void
+register_symmetric_heap(size_t heapno, mem_info_t *mip)
+{
+    shmemu_assert(proc.env.heaps.heapsize[heapno] > 0,
+                  "Cannot register empty symmetric heap #%lu",
+                  (unsigned long) heapno);
+
+    map_heap_region(heapno, same_va_slot(heapno),
+                    proc.env.heaps.heapsize[heapno], mip);
+
+    /* the default heap's allocator (others are named extensions) */
+    if (heapno == 0) {
+        shmema_init((void *) mip->base, mip->len);
+    }
 }
 
 inline static void
@@ -240,6 +874,10 @@ deregister_symmetric_heap(mem_info_t *mip)
     shmemu_assert(s == UCS_OK,
                   "can't unmap memory for symmetric heap #%lu: %s",
                   hn, ucs_status_string(s));
+
+    if (mip->own_alloc) {
+        (void) munmap((void *) mip->base, mip->len);
+    }
 }
 
 /*
@@ -251,8 +889,9 @@ opaque_rkeys_init(void)
 {
     size_t r;
 
+    /* room for heap growth, filled in as it happens */
     proc.comms.orks = (mem_opaque_t *)
-        calloc(proc.comms.nregions, sizeof(mem_opaque_t));
+        calloc(proc.comms.maxregions, sizeof(mem_opaque_t));
     shmemu_assert(proc.comms.orks != NULL,
                   "can't allocate memory for opaque rkeys");
 
@@ -271,10 +910,12 @@ opaque_rkeys_finalize(void)
     size_t r;
     int pe;
 
-    /* clear opaque rkeys */
+    /* clear opaque rkeys (growth regions never in node segment) */
     for (r = 0; r < proc.comms.nregions; ++r) {
-        for (pe = 0; pe < proc.nranks; ++pe) {
-            free(proc.comms.orks[r].rkeys[pe].data);
+        if ((! proc.comms.boot_shared) || (r > proc.env.heaps.nheaps)) {
+            for (pe = 0; pe < proc.nranks; ++pe) {
+                free(proc.comms.orks[r].rkeys[pe].data);
+            }
         }
     }
 }
@@ -287,9 +928,15 @@ init_memory_regions(void)
     /* 1 globals region, plus symmetric heaps */
     proc.comms.nregions = 1 + proc.env.heaps.nheaps;
 
+    /* plus whatever the default heap might grow by */
+    proc.comms.maxregions = proc.comms.nregions;
+    if (proc.env.heap_grow > 0) {
+        proc.comms.maxregions += SHMEMC_MAX_HEAP_EXTENSIONS;
+    }
+
     /* init that many regions on me */
     proc.comms.regions =
-        (mem_region_t *) calloc(proc.comms.nregions, sizeof(mem_region_t));
+        (mem_region_t *) calloc(proc.comms.maxregions, sizeof(mem_region_t));
     shmemu_assert(proc.comms.regions != NULL,
                   "can't allocate memory for memory regions");
 
@@ -315,14 +962,92 @@ register_memory_regions(void)
     size_t hi;
 
     register_globals();
+    proc.comms.regions[0].aligned = true;
 
     for (hi = 1; hi < proc.comms.nregions; ++hi) {
         mem_info_t *shp = & proc.comms.regions[hi].minfo[proc.rank];
 
         register_symmetric_heap(hi - 1, shp);
+        proc.comms.regions[hi].aligned = (same_va_base != 0);
+    }
+}
+
+/*
+ * sort local regions by address so translation can binary-search
+ * them instead of walking every region
+ */
+
+static int
+region_index_cmp(const void *a, const void *b)
+{
+    const mem_region_index_t *ra = (const mem_region_index_t *) a;
+    const mem_region_index_t *rb = (const mem_region_index_t *) b;
+
+    if (ra->base < rb->base) {
+        return -1;
+    }
+    else if (ra->base > rb->base) {
+        return 1;
+    }
+    else {
+        return 0;
     }
 }
 
+/*
+ * build a new index of the first N regions and make it the one
+ * translation uses
+ */
+
+static void
+region_table_publish(size_t n)
+{
+    mem_region_table_t *rtp;
+    size_t r;
+
+    rtp = (mem_region_table_t *)
+        malloc(sizeof(*rtp) + n * sizeof(rtp->index[0]));
+    shmemu_assert(rtp != NULL,
+                  "can't allocate memory for region index");
+
+    rtp->prev = proc.comms.rtable;
+    rtp->nregions = n;
+
+    for (r = 0; r < n; ++r) {
+        const mem_info_t *mip = & proc.comms.regions[r].minfo[proc.rank];
+
+        rtp->index[r].base   = mip->base;
+        rtp->index[r].end    = mip->end;
+        rtp->index[r].region = (long) r;
+    }
+
+    qsort(rtp->index, n, sizeof(rtp->index[0]), region_index_cmp);
+
+    __atomic_store_n(& proc.comms.rtable, rtp, __ATOMIC_RELEASE);
+}
+
+inline static void
+region_index_init(void)
+{
+    proc.comms.rtable = NULL;
+
+    region_table_publish(proc.comms.nregions);
+}
+
+inline static void
+region_index_finalize(void)
+{
+    mem_region_table_t *rtp = proc.comms.rtable;
+
+    while (rtp != NULL) {
+        mem_region_table_t *prev = rtp->prev;
+
+        free(rtp);
+        rtp = prev;
+    }
+    proc.comms.rtable = NULL;
+}
+
 inline static void
 deregister_memory_regions(void)
 {
@@ -339,12 +1064,110 @@ deregister_memory_regions(void)
 
     deregister_globals();
 
+    same_va_release();
+
     for (hi = 0; hi < proc.comms.nregions; ++hi) {
         free(proc.comms.regions[hi].minfo);
     }
     free(proc.comms.regions);
 }
 
+/*
+ * Growing the default heap.  The caller runs this collectively:
+ * begin on every PE, then tell us about every PE's new region, then
+ * end, which makes it visible to translation.  Extensions are mapped
+ * like heap #0.
+ */
+
+static void *extend_rkey = NULL; /* our packed rkey, while exchanging */
+
+bool
+shmemc_heap_extend_begin(size_t len,
+                         uint64_t *base_p, size_t *len_p,
+                         void **rkey_p, size_t *rkey_len_p)
+{
+    const size_t r = proc.comms.nregions;
+    mem_info_t *mip;
+    ucs_status_t s;
+
+    if (r == proc.comms.maxregions) {
+        logger(LOG_MEMORY,
+               "can't grow symmetric heap: already extended %lu times",
+               (unsigned long) (r - 1 - proc.env.heaps.nheaps));
+        return false;
+        /* NOT REACHED */
+    }
+
+    proc.comms.regions[r].minfo =
+        (mem_info_t *) calloc(proc.nranks, sizeof(mem_info_t));
+    proc.comms.orks[r].rkeys =
+        (mem_opaque_rkey_t *) calloc(proc.nranks, sizeof(mem_opaque_rkey_t));
+    shmemu_assert((proc.comms.regions[r].minfo != NULL) &&
+                  (proc.comms.orks[r].rkeys != NULL),
+                  "can't allocate memory to grow symmetric heap");
+
+    mip = & proc.comms.regions[r].minfo[proc.rank];
+
+    map_heap_region(0, NULL, len, mip);
+
+    s = shmemc_ucx_rkey_pack(mip->mh, &extend_rkey, rkey_len_p);
+    shmemu_assert(s == UCS_OK,
+                  "can't pack rkey for symmetric heap extension: %s",
+                  ucs_status_string(s));
+
+    *base_p = mip->base;
+    *len_p = mip->len;
+    *rkey_p = extend_rkey;
+
+    return true;
+}
+
+void
+shmemc_heap_extend_peer(int pe,
+                        uint64_t base, size_t len,
+                        const void *rkey, size_t rkey_len)
+{
+    const size_t r = proc.comms.nregions;
+    void *data = malloc(rkey_len);
+
+    shmemu_assert(data != NULL,
+                  "can't allocate memory for rkey from PE %d", pe);
+    memcpy(data, rkey, rkey_len);
+
+    proc.comms.orks[r].rkeys[pe].data = data;
+
+    if (pe != proc.rank) {
+        mem_info_t *mip = & proc.comms.regions[r].minfo[pe];
+
+        mip->base = base;
+        mip->len  = len;
+        mip->end  = base + len;
+    }
+}
+
+void
+shmemc_heap_extend_end(void)
+{
+    const size_t n = proc.comms.nregions + 1;
+
+    ucp_rkey_buffer_release(extend_rkey);
+    extend_rkey = NULL;
+
+    /*
+     * Index first: a region's only found through it, and by then
+     * everything it needs is in place.  Contexts unpack its rkeys on
+     * first use.
+     */
+    region_table_publish(n);
+    __atomic_store_n(& proc.comms.nregions, n, __ATOMIC_RELEASE);
+
+    logger(LOG_MEMORY,
+           "symmetric heap extended: region %lu, %lu bytes at %p",
+           (unsigned long) (n - 1),
+           (unsigned long) proc.comms.regions[n - 1].minfo[proc.rank].len,
+           (void *) proc.comms.regions[n - 1].minfo[proc.rank].base);
+}
+
 /**
  * API
  *
@@ -357,6 +1180,9 @@ deregister_memory_regions(void)
 
 long *shmemc_barrier_all_psync;
 long *shmemc_sync_all_psync;
+#ifdef ENABLE_DEBUG
+long *shmemc_batch_check_hash;  /* see shmemx_malloc_batch */
+#endif  /* ENABLE_DEBUG */
 
 #define ALLOC_INTERNAL_SYMM_VAR(_var)                                   \
     do {                                                                \
@@ -399,6 +1225,10 @@ ucx_init_ready(void)
         UCP_FEATURE_RMA      |  /* put/get */
         UCP_FEATURE_AMO32    |  /* 32-bit atomics */
         UCP_FEATURE_AMO64;      /* 64-bit atomics */
+#ifdef HAVE_UCP_AM_SEND_NB
+    pm.features |=
+        UCP_FEATURE_AM;         /* atomics UCX can't do */
+#endif  /* HAVE_UCP_AM_SEND_NB */
 
     pm.mt_workers_shared = (proc.td.osh_tl > SHMEM_THREAD_SINGLE);
 
@@ -433,17 +1263,28 @@ void
 shmemc_ucx_init(void)
 {
     ucx_init_ready();
+    shmemc_startup_phase("ucx");
 
     /* user-supplied setup */
     shmemc_env_init();
 
     /* make remote memory usable */
     init_memory_regions();
+#ifndef ENABLE_ALIGNED_ADDRESSES
+    if (proc.env.heap_same_va) {
+        same_va_negotiate();
+    }
+#endif  /* ! ENABLE_ALIGNED_ADDRESSES */
     register_memory_regions();
+    region_index_init();
+    shmemc_startup_phase("heaps");
 
     /* master copy of exchanged rkeys */
     opaque_rkeys_init();
 
+    /* local staging buffers for puts */
+    shmemc_ucx_bounce_init();
+
     /* Create exchange workers and space for EPs */
     allocate_xworkers_table();
 
@@ -457,11 +1298,15 @@ shmemc_ucx_init(void)
     /* pre-allocate internal sync variables */
     ALLOC_INTERNAL_SYMM_VAR(shmemc_barrier_all_psync);
     ALLOC_INTERNAL_SYMM_VAR(shmemc_sync_all_psync);
+#ifdef ENABLE_DEBUG
+    ALLOC_INTERNAL_SYMM_VAR(shmemc_batch_check_hash);
+#endif  /* ENABLE_DEBUG */
 
     ucx_ready();
 
     /* set up globalexit handler */
     shmemc_globalexit_init();
+    shmemc_startup_phase("ucx-setup");
 }
 
 /*
@@ -482,9 +1327,15 @@ shmemc_ucx_finalize(void)
     /* free up internal sync variables */
     FREE_INTERNAL_SYMM_VAR(shmemc_barrier_all_psync);
     FREE_INTERNAL_SYMM_VAR(shmemc_sync_all_psync);
+#ifdef ENABLE_DEBUG
+    FREE_INTERNAL_SYMM_VAR(shmemc_batch_check_hash);
+#endif  /* ENABLE_DEBUG */
+
+    shmemc_ucx_bounce_finalize();
 
     opaque_rkeys_finalize();
 
+    region_index_finalize();
     deregister_memory_regions();
 
     shmemc_env_finalize();
@@ -36,6 +36,7 @@ typedef struct mem_opaque {
 
 typedef struct mem_access {
     ucp_rkey_h rkey;            /* remote key for this heap */
+    void *mapped;               /* local mapping of remote base, or NULL */
 } mem_access_t;
 
 typedef struct mem_region_access {
@@ -52,6 +53,8 @@ typedef struct mem_info {
     uint64_t end;               /* end of this heap */
     size_t len;                 /* its size (b) */
     ucp_mem_h mh;               /* memory handle */
+    size_t pagesize;            /* what backs it, 0 if left to UCX */
+    bool own_alloc;             /* we mapped it, not UCX */
 } mem_info_t;
 
 /*
@@ -59,8 +62,29 @@ typedef struct mem_info {
  */
 typedef struct mem_region {
     mem_info_t *minfo;          /**< nranks mem info */
+    bool aligned;               /**< at the same address on every PE */
 } mem_region_t;
 
+/*
+ * local regions sorted by base address, for address -> region lookup
+ */
+typedef struct mem_region_index {
+    uint64_t base;              /* start of region on this PE */
+    uint64_t end;               /* end of region on this PE */
+    long region;                /* which region this is */
+} mem_region_index_t;
+
+/*
+ * The index is replaced, not updated, when the heap grows, so
+ * translation can read it without locks.  Old ones hang around until
+ * finalize in case someone's still looking at them.
+ */
+typedef struct mem_region_table {
+    struct mem_region_table *prev; /* retired tables */
+    size_t nregions;            /* entries in index */
+    mem_region_index_t index[];
+} mem_region_table_t;
+
 /*
  * *Internal* OpenSMHEM context management handle
  *
@@ -97,11 +121,33 @@ typedef struct shmemc_context_attr {
     bool serialized;
     bool private;
     bool nostore;
+    bool coalesce;              /* buffer small puts (extension) */
 } shmemc_context_attr_t;
 
+/*
+ * a run of small puts to one PE, waiting to go out as one transfer
+ */
+typedef struct put_combine {
+    char *dest;                 /* where run starts (local address) */
+    size_t nbytes;              /* how much is buffered */
+    char *buf;                  /* the buffered data */
+    bool listed;                /* in context's list of active PEs */
+} put_combine_t;
+
+/*
+ * endpoints used since the last quiet, so we only flush those
+ */
+typedef struct ep_dirty_set {
+    bool enabled;               /* else flush the whole worker */
+    bool *flags;                /* per-PE: already in list? */
+    int *pes;                   /* compact list of used PEs */
+    int npes;                   /* how many in list */
+    ucs_status_ptr_t *reqs;     /* overlapped flush requests */
+} ep_dirty_set_t;
+
 typedef struct shmemc_context {
     ucp_worker_h w;             /* for separate context progress */
-    ucp_ep_h *eps;              /* endpoints */
+    ucp_ep_h *eps;              /* endpoints, NULL until first used */
     unsigned long id;           /* internal tracking */
     threadwrap_thread_t creator_thread; /* thread ID that created me */
     /*
@@ -110,9 +156,22 @@ typedef struct shmemc_context {
     shmemc_context_attr_t attr;
 
     mem_region_access_t *racc;  /* for endpoint remote access */
+    int connect_lock;           /* serializes connecting to PEs */
 
     shmemc_team_h team;         /* team we belong to */
 
+    long last_region;           /* region of most recent lookup */
+
+    unsigned long nsignals;     /* put-signals waiting on their data */
+    uint64_t signal_scratch;    /* signal swap results, unused */
+    unsigned long nfetches;     /* non-blocking fetching AMOs in flight */
+
+    put_combine_t *combine;     /* per-PE put buffers if coalescing */
+    int *combine_pes;           /* PEs with something buffered */
+    int ncombine;               /* how many of those */
+
+    ep_dirty_set_t dirty;       /* endpoints quiet has to flush */
+
     /*
      * possibly other things
      */
@@ -133,8 +192,18 @@ typedef struct comms_info {
 
     mem_region_t *regions;      /**< exchanged symmetric regions */
     size_t nregions;            /**< how many regions */
+    size_t maxregions;          /**< room for this many (heap growth) */
+    mem_region_table_t *rtable; /**< regions sorted by local address */
 
     mem_opaque_t *orks;         /* opaque rkeys (nregions * PEs) */
+    bool boot_shared;           /* exchanged workers & rkeys live in
+                                   node bootstrap segment */
+
+    unsigned amo_am_ops;        /* bitmask of shmemc_amo_op_t sent as
+                                   active messages */
+
+    mem_info_t bounce;          /* registered local buffer pool (len
+                                   0 if none) */
 } comms_info_t;
 
 typedef struct thread_desc {
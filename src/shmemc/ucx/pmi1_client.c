@@ -7,6 +7,8 @@
 #include "thispe.h"
 #include "shmemu.h"
 #include "state.h"
+#include "pmi_client.h"
+#include "ucx/api.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,248 +43,194 @@ alloc_string(size_t n)
 
 /* -------------------------------------------------------------- */
 
-static const char *wrkr_exch_fmt = "%d:wrkr:addr"; /* pe */
-
 /*
  * PMI key/val lookups
  */
 static char *key = NULL;
 static char *val = NULL;
 
-void
-shmemc_pmi_publish_worker(void)
-{
-    int ps;
+/*
+ * PMI-1 values are strings of limited length, so the bootstrap blob
+ * is hex-encoded.  The first key carries the blob length and as much
+ * of the blob as fits; anything left over spills into numbered keys.
+ */
 
-    /* everyone publishes their info */
-    snprintf(key, kvs_max_key_len,
-             wrkr_exch_fmt,
-             proc.rank);
-    memcpy(val,
-           & proc.comms.xchg_wrkr_info[proc.rank],
-           sizeof(proc.comms.xchg_wrkr_info[proc.rank]));
+static const char *boot_exch_fmt  = "boot:%d";    /* pe */
+static const char *boot_chunk_fmt = "boot:%d:%d"; /* pe, chunk */
 
-    ps = PMI_KVS_Put(kvs_name, key, val);
-    shmemu_assert(ps == PMI_SUCCESS,
-                  "put of worker blob failed (status %d)",
-                  ps);
+#define LEN_DIGITS 16           /* blob length prefix, hex */
+
+static const char *hexdigits = "0123456789abcdef";
+
+inline static int
+unhex(char c)
+{
+    return (c <= '9') ? (c - '0') : (c - 'a' + 10);
 }
 
-static const char *rkey_exch_fmt   = "rkey:%lu:%d"; /* region, pe */
+/*
+ * encode/decode as many bytes as fit in "room" characters
+ */
+inline static size_t
+encode_chunk(char *dest, size_t room, const unsigned char *src, size_t n)
+{
+    size_t i;
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-static const char *heap_exch_fmt = "heap:%lu:%d"; /* region, pe */
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
+    if (n > room / 2) {
+        n = room / 2;
+    }
+    for (i = 0; i < n; ++i) {
+        dest[2 * i]     = hexdigits[src[i] >> 4];
+        dest[2 * i + 1] = hexdigits[src[i] & 0xf];
+    }
+    dest[2 * n] = '\0';
 
-inline static void
-publish_one_rkeys(size_t r)
+    return n;
+}
+
+inline static size_t
+decode_chunk(unsigned char *dest, const char *src, size_t n)
 {
-    int ps;
-    int next;
-    void *packed_rkey;
-    size_t rkey_len;
-    const ucs_status_t s =
-        ucp_rkey_pack(proc.comms.ucx_ctxt,
-                      proc.comms.regions[r].minfo[proc.rank].racc.mh,
-                      &packed_rkey, &rkey_len
-                      );
-    shmemu_assert(s == UCS_OK, "can't pack rkey");
-
-    snprintf(key, kvs_max_key_len, rkey_exch_fmt, proc.rank);
-
-    next = snprintf(val, kvs_max_value_len,
-                    "%8lu",
-                    (unsigned long) rkey_len);
-    memcpy(val + next, packed_rkey, rkey_len);
-
-    ps = PMI_KVS_Put(kvs_name, key, val);
-    shmemu_assert(ps == PMI_SUCCESS,
-                  "put of worker blob failed (status %d)",
-                  ps);
+    size_t i;
 
-    ucp_rkey_buffer_release(packed_rkey);
+    for (i = 0; (i < n) && (src[2 * i] != '\0'); ++i) {
+        dest[i] = (unhex(src[2 * i]) << 4) | unhex(src[2 * i + 1]);
+    }
+
+    return i;
 }
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
 inline static void
-publish_one_heap(size_t r)
+kvs_put(void)
 {
-    int ps;
-    const mem_info_t *mp = & proc.comms.regions[r].minfo[proc.rank];
+    const int ps = PMI_KVS_Put(kvs_name, key, val);
 
-    /* everyone publishes their info */
-    snprintf(key, kvs_max_key_len,
-             heap_exch_fmt,
-             proc.rank);
-    memcpy(val, mp, sizeof(*mp));
-
-    ps = PMI_KVS_Put(kvs_name, key, val);
     shmemu_assert(ps == PMI_SUCCESS,
-                  "put of heap blob failed (status %d)",
+                  "put of bootstrap blob failed (status %d)",
                   ps);
 }
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
 
-void
-shmemc_pmi_publish_rkeys_and_heaps(void)
+inline static void
+kvs_get(int pe)
 {
-    size_t r;
-
-    publish_one_rkeys(0);
-
-    for (r = 1; r < proc.comms.nregions; ++r) {
-        publish_one_rkeys(r);
+    const int ps = PMI_KVS_Get(kvs_name, key, val, kvs_max_value_len);
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-        publish_one_heap(r);
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-    }
+    shmemu_assert(ps == PMI_SUCCESS,
+                  "fetch of bootstrap blob from PE %d failed (status %d)",
+                  pe, ps);
 }
 
 void
-shmemc_pmi_exchange_workers(void)
+shmemc_pmi_publish_bootstrap(void)
 {
-    int pe;
-
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        int ps;
-        worker_info_t *wp;
-        const int i = shmemu_shift(pe);
-
-        snprintf(key, kvs_max_key_len,
-                 wrkr_exch_fmt,
-                 i);
+    const size_t room = kvs_max_value_len - 1;
+    unsigned char *blob;
+    size_t len;
+    size_t done;
+    int chunk;
 
-        ps = PMI_KVS_Get(kvs_name, key, val, kvs_max_value_len);
-        shmemu_assert(ps == PMI_SUCCESS,
-                      "get of remote worker blob failed (status %d)",
-                      ps);
+    shmemc_ucx_bootstrap_pack((void **) &blob, &len);
 
-        wp = (worker_info_t *) val;
+    snprintf(key, kvs_max_key_len, boot_exch_fmt, proc.rank);
+    snprintf(val, kvs_max_value_len, "%0*lx",
+             LEN_DIGITS, (unsigned long) len);
+    done = encode_chunk(val + LEN_DIGITS, room - LEN_DIGITS, blob, len);
+    kvs_put();
 
-        proc.comms.xchg_wrkr_info[i].buf = (char *) malloc(wp->len);
-        shmemu_assert(proc.comms.xchg_wrkr_info[i].buf != NULL,
-                      "can't allocate memory for remote worker blob");
-        memcpy(proc.comms.xchg_wrkr_info[i].buf, wp->addr, wp->len);
+    for (chunk = 1; done < len; ++chunk) {
+        snprintf(key, kvs_max_key_len, boot_chunk_fmt, proc.rank, chunk);
+        done += encode_chunk(val, room, blob + done, len - done);
+        kvs_put();
     }
+
+    free(blob);
 }
 
-inline static void
-exchange_one_rkeys(size_t r, int pe)
+void *
+shmemc_pmi_fetch_bootstrap(int pe, size_t *len_p)
 {
-    const int i = shmemu_shift(pe);
-    int ps;
-    ucs_status_t s;
-    size_t len;
+    unsigned char *blob;
+    unsigned long len;
+    size_t done;
+    int chunk;
 
-    snprintf(key, kvs_max_key_len,
-             rkey_exch_fmt,
-             r, i);
+    snprintf(key, kvs_max_key_len, boot_exch_fmt, pe);
+    kvs_get(pe);
 
-    ps = PMI_KVS_Get(kvs_name, key, val, kvs_max_value_len);
-    shmemu_assert(ps == PMI_SUCCESS,
-                  "fetch of rkey from PE %d failed (status %d)",
-                  i, ps);
-
-    sscanf(val, "%8lu", (unsigned long *) &len);
-
-    proc.comms.regions[r].minfo[i].racc.rkey =
-        (ucp_rkey_h) malloc(len);
-    shmemu_assert(proc.comms.regions[r].minfo[i].racc.rkey != NULL,
-                  "can't allocate memory for remote rkey");
-
-    s = ucp_ep_rkey_unpack(proc.comms.eps[i],
-                           val + len,
-                           &proc.comms.regions[r].minfo[i].racc.rkey
-                           );
-    shmemu_assert(s == UCS_OK, "can't unpack remote rkey");
-}
+    sscanf(val, "%16lx", &len);
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-inline static void
-exchange_one_heap(size_t r, int pe)
-{
-    int ps;
-    mem_info_t *mp;
+    blob = (unsigned char *) malloc(len);
+    shmemu_assert(blob != NULL,
+                  "can't allocate memory for bootstrap blob from PE %d",
+                  pe);
 
-    snprintf(key, kvs_max_key_len,
-             heap_exch_fmt,
-             r, pe);
+    done = decode_chunk(blob, val + LEN_DIGITS, len);
 
-    ps = PMI_KVS_Get(kvs_name, key, val, kvs_max_value_len);
-    shmemu_assert(ps == PMI_SUCCESS,
-                  "fetch of rkey from PE %d failed (status %d)",
-                  pe, ps);
+    for (chunk = 1; done < len; ++chunk) {
+        snprintf(key, kvs_max_key_len, boot_chunk_fmt, pe, chunk);
+        kvs_get(pe);
+        done += decode_chunk(blob + done, val, len - done);
+    }
 
-    mp = (mem_info_t *) val;
+    *len_p = len;
 
-    proc.comms.regions[r].minfo[pe].base =
-        mp->base;
-    proc.comms.regions[r].minfo[pe].len =
-        mp->len;
-    /* slightly redundant storage, but useful */
-    proc.comms.regions[r].minfo[pe].end =
-        proc.comms.regions[r].minfo[pe].base +
-        mp->len;
+    return blob;
 }
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
 
-inline static void
-exchange_all_rkeys(size_t r)
-{
-    int pe;
+/*
+ * single values, keyed on name and the publishing PE
+ */
 
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        const int i = shmemu_shift(pe);
+static const char *value_exch_fmt = "%s:%d"; /* name, pe */
 
-        exchange_one_rkeys(r, i);
-    }
+void
+shmemc_pmi_publish_value(const char *name, uint64_t v)
+{
+    snprintf(key, kvs_max_key_len, value_exch_fmt, name, proc.rank);
+    snprintf(val, kvs_max_value_len, "%lx", (unsigned long) v);
+    kvs_put();
 }
 
-inline static void
-exchange_one_rkeys_and_heaps(size_t r)
+uint64_t
+shmemc_pmi_fetch_value(int pe, const char *name)
 {
-    int pe;
+    unsigned long v = 0;
 
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        const int i = shmemu_shift(pe);
+    snprintf(key, kvs_max_key_len, value_exch_fmt, name, pe);
+    kvs_get(pe);
 
-        exchange_one_rkeys(r, i);
+    sscanf(val, "%lx", &v);
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-        exchange_one_heap(r, i);
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-    }  /* PE loop */
+    return (uint64_t) v;
 }
 
-void
-shmemc_pmi_exchange_rkeys_and_heaps(void)
-{
-    size_t r;
-
-    /* global rkeys */
-    exchange_all_rkeys(0);
+/*
+ * something that identifies this job on a node
+ */
 
-    /* now everything else */
-    for (r = 1; r < proc.comms.nregions; ++r) {
-        exchange_one_rkeys_and_heaps(r);
-    }
+const char *
+shmemc_pmi_job_name(void)
+{
+    return kvs_name;
 }
 
 /* -------------------------------------------------------------- */
 
 /*
  * this barrier is purely for internal use with PMI, nothing to do
- * with SHMEM/UCX
+ * with SHMEM/UCX.  PMI-1 always makes everything visible, so
+ * "collect_data" makes no difference.
  */
 void
-shmemc_pmi_barrier_all(void)
+shmemc_pmi_barrier_all(bool collect_data)
 {
     int ps;
 
+    NO_WARN_UNUSED(collect_data);
+
     ps = PMI_KVS_Commit(kvs_name);
     shmemu_assert(ps == PMI_SUCCESS,
-                  "worker blob commit failed (status %d)",
+                  "bootstrap blob commit failed (status %d)",
                   ps);
 
     ps = PMI_Barrier();
@@ -367,25 +315,12 @@ void
 shmemc_pmi_client_finalize(void)
 {
     int ps;
-    int pe;
 
     ps = PMI_Finalize();
     shmemu_assert(ps == PMI_SUCCESS,
                   "PMI can't finalize (status %d)",
                   ps);
 
-    /* TODO: PMI client common code below */
-
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        size_t r;
-
-        /* clean up allocations for exchanged buffers */
-        free(proc.comms.xchg_wrkr_info[pe].buf);
-        for (r = 0; r < proc.comms.nregions; ++r) {
-            ucp_rkey_destroy(proc.comms.regions[r].minfo[pe].racc.rkey);
-        }
-    }
-
     /* clean up locally allocated memory */
     free(proc.peers);
     free(kvs_name);
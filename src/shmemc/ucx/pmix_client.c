@@ -29,107 +29,35 @@ static pmix_proc_t my_proc;     /* about me */
 static pmix_proc_t wc_proc;     /* wildcard lookups */
 static pmix_proc_t ex_proc;     /* internal exchanges */
 
-static pmix_key_t k1;           /* re-usable key spaces */
-#ifndef ENABLE_ALIGNED_ADDRESSES
-static pmix_key_t k2;
-#endif /* ENABLE_ALIGNED_ADDRESSES */
+static pmix_key_t k1;           /* re-usable key space */
 
 static pmix_status_t ps;        /* re-usable pmix status */
 
 /*
- * Make local info avaialable to PMIx
+ * Make local info avaialable to PMIx: everything goes in one blob
  */
 
-static const char *wrkr_exch_fmt   = "wrkr:%d";     /* pe */
+static const char *boot_exch_fmt = "boot:%d";      /* pe */
 
 void
-shmemc_pmi_publish_worker(void)
+shmemc_pmi_publish_bootstrap(void)
 {
     pmix_value_t v;
+    void *blob;
+    size_t len;
 
-    /* everyone publishes their info */
-    snprintf(k1, PMIX_MAX_KEYLEN, wrkr_exch_fmt, proc.rank);
-
-    v.type = PMIX_BYTE_OBJECT;
-    v.data.bo.bytes = (char *) proc.comms.xchg_wrkr_info[proc.rank].addr;
-    v.data.bo.size = proc.comms.xchg_wrkr_info[proc.rank].len;
-
-    ps = PMIx_Put(PMIX_GLOBAL, k1, &v);
-    shmemu_assert(ps == PMIX_SUCCESS, "can't publish worker blob");
-}
-
-static const char *rkey_exch_fmt   = "rkey:%lu:%d"; /* region, pe */
-
-inline static void
-publish_one_rkeys(size_t r)
-{
-    pmix_value_t v;
-    void *packed_rkey;
-    size_t rkey_len;
-    const ucs_status_t s =
-        shmemc_ucx_rkey_pack(proc.comms.regions[r].minfo[proc.rank].mh,
-                             &packed_rkey, &rkey_len
-                             );
-    shmemu_assert(s == UCS_OK, "can't pack rkey");
+    shmemc_ucx_bootstrap_pack(&blob, &len);
 
-    snprintf(k1, PMIX_MAX_KEYLEN, rkey_exch_fmt, r, proc.rank);
+    snprintf(k1, PMIX_MAX_KEYLEN, boot_exch_fmt, proc.rank);
 
     v.type = PMIX_BYTE_OBJECT;
-    v.data.bo.bytes = (char *) packed_rkey;
-    v.data.bo.size = rkey_len;
+    v.data.bo.bytes = (char *) blob;
+    v.data.bo.size = len;
 
     ps = PMIx_Put(PMIX_GLOBAL, k1, &v);
-    shmemu_assert(ps == PMIX_SUCCESS,
-                  "can't publish rkey for memory region %lu",
-                  r);
+    shmemu_assert(ps == PMIX_SUCCESS, "can't publish bootstrap blob");
 
-    ucp_rkey_buffer_release(packed_rkey);
-}
-
-#ifndef ENABLE_ALIGNED_ADDRESSES
-static const char *region_base_fmt = "base:%lu:%d"; /* region, pe */
-static const char *region_size_fmt = "size:%lu:%d"; /* region, pe */
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-
-#ifndef ENABLE_ALIGNED_ADDRESSES
-inline static void
-publish_one_heap(size_t r)
-{
-    pmix_value_t vb, vs;
-
-    snprintf(k1, PMIX_MAX_KEYLEN, region_base_fmt, r, proc.rank);
-    snprintf(k2, PMIX_MAX_KEYLEN, region_size_fmt, r, proc.rank);
-
-    vb.type = PMIX_UINT64;
-    vb.data.uint64 = proc.comms.regions[r].minfo[proc.rank].base;
-    vs.type = PMIX_SIZE;
-    vs.data.size = proc.comms.regions[r].minfo[proc.rank].len;
-
-    ps = PMIx_Put(PMIX_GLOBAL, k1, &vb);
-    shmemu_assert(ps == PMIX_SUCCESS,
-                  "can't publish heap base for memory region %lu",
-                  r);
-    ps = PMIx_Put(PMIX_GLOBAL, k2, &vs);
-    shmemu_assert(ps == PMIX_SUCCESS,
-                  "can't publish heap size for memory region %lu",
-                  r);
-}
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-
-void
-shmemc_pmi_publish_rkeys_and_heaps(void)
-{
-    size_t r;
-
-    publish_one_rkeys(0);
-
-    for (r = 1; r < proc.comms.nregions; ++r) {
-        publish_one_rkeys(r);
-
-#ifndef ENABLE_ALIGNED_ADDRESSES
-        publish_one_heap(r);
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-    }
+    free(blob);
 }
 
 /* -------------------------------------------------------------- */
@@ -138,137 +66,81 @@ shmemc_pmi_publish_rkeys_and_heaps(void)
  * Get remote info out of PMIx
  */
 
-void
-shmemc_pmi_exchange_workers(void)
+void *
+shmemc_pmi_fetch_bootstrap(int pe, size_t *len_p)
 {
     pmix_value_t *vp = NULL;
-    int pe;
+    void *blob;
 
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        pmix_byte_object_t *bop;
-
-        snprintf(k1, PMIX_MAX_KEYLEN, wrkr_exch_fmt, pe);
-        ex_proc.rank = pe;
+    snprintf(k1, PMIX_MAX_KEYLEN, boot_exch_fmt, pe);
+    ex_proc.rank = pe;
 
-        ps = PMIx_Get(&ex_proc, k1, NULL, 0, &vp);
-        shmemu_assert(ps == PMIX_SUCCESS,
-                      "can't find remote worker blob for PE %d",
-                      pe);
+    ps = PMIx_Get(&ex_proc, k1, NULL, 0, &vp);
+    shmemu_assert(ps == PMIX_SUCCESS,
+                  "can't fetch bootstrap blob from PE %d",
+                  pe);
 
-        bop = & vp->data.bo;
+    blob = malloc(vp->data.bo.size);
+    shmemu_assert(blob != NULL,
+                  "can't allocate memory for bootstrap blob from PE %d",
+                  pe);
+    memcpy(blob, vp->data.bo.bytes, vp->data.bo.size);
+    *len_p = vp->data.bo.size;
 
-        /* save published worker */
-        proc.comms.xchg_wrkr_info[pe].buf = (char *) malloc(bop->size);
-        shmemu_assert(proc.comms.xchg_wrkr_info[pe].buf != NULL,
-                      "can't allocate memory for remote workers for PE %d",
-                      pe);
-        memcpy(proc.comms.xchg_wrkr_info[pe].buf, bop->bytes, bop->size);
-    }
     PMIX_VALUE_RELEASE(vp);
-}
 
-#ifndef ENABLE_ALIGNED_ADDRESSES
-inline static void
-exchange_one_heap(size_t r, int pe)
-{
-    pmix_value_t *vpb = NULL;
-    pmix_value_t *vps = NULL;
-    uint64_t base;
-    size_t len;
-
-    ex_proc.rank = pe;
+    return blob;
+}
 
-    snprintf(k1, PMIX_MAX_KEYLEN, region_base_fmt, r, pe);
-    snprintf(k2, PMIX_MAX_KEYLEN, region_size_fmt, r, pe);
+/*
+ * single values, keyed on name and the publishing PE
+ */
 
-    ps = PMIx_Get(&ex_proc, k1, NULL, 0, &vpb);
-    shmemu_assert(ps == PMIX_SUCCESS,
-                  "can't fetch heap base for memory region %lu from PE %d",
-                  r, pe);
+static const char *value_exch_fmt = "%s:%d"; /* name, pe */
 
-    ps = PMIx_Get(&ex_proc, k2, NULL, 0, &vps);
-    shmemu_assert(ps == PMIX_SUCCESS,
-                  "can't fetch heap size for memory region %lu from PE %d",
-                  r, pe);
+void
+shmemc_pmi_publish_value(const char *name, uint64_t v)
+{
+    pmix_value_t pv;
 
-    base = vpb->data.uint64;
-    len  = vps->data.size;
+    snprintf(k1, PMIX_MAX_KEYLEN, value_exch_fmt, name, proc.rank);
 
-    proc.comms.regions[r].minfo[pe].base = base;
-    proc.comms.regions[r].minfo[pe].len = len;
-    /* slightly redundant storage, but useful */
-    proc.comms.regions[r].minfo[pe].end = base + len;
+    pv.type = PMIX_UINT64;
+    pv.data.uint64 = v;
 
-    PMIX_VALUE_RELEASE(vps);
-    PMIX_VALUE_RELEASE(vpb);
+    ps = PMIx_Put(PMIX_GLOBAL, k1, &pv);
+    shmemu_assert(ps == PMIX_SUCCESS, "can't publish \"%s\"", k1);
 }
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
 
-inline static void
-exchange_one_rkeys(size_t r, int pe)
+uint64_t
+shmemc_pmi_fetch_value(int pe, const char *name)
 {
     pmix_value_t *vp = NULL;
-    pmix_byte_object_t *bop;
+    uint64_t v;
 
+    snprintf(k1, PMIX_MAX_KEYLEN, value_exch_fmt, name, pe);
     ex_proc.rank = pe;
 
-    snprintf(k1, PMIX_MAX_KEYLEN, rkey_exch_fmt, r, pe);
-
     ps = PMIx_Get(&ex_proc, k1, NULL, 0, &vp);
     shmemu_assert(ps == PMIX_SUCCESS,
-                  "can't fetch remote rkey for memory region %lu from PE %d",
-                  r, pe);
-
-    bop = & vp->data.bo;
+                  "can't fetch \"%s\" from PE %d",
+                  k1, pe);
 
-    /* opaque rkey */
-    proc.comms.orks[r].rkeys[pe].data = malloc(bop->size);
-    shmemu_assert(proc.comms.orks[r].rkeys[pe].data != NULL,
-                  "can't allocate memory for rkey data"
-                  " for memory region %lu from PE %d",
-                  r, pe);
-
-    memcpy(proc.comms.orks[r].rkeys[pe].data, bop->bytes, bop->size);
+    v = vp->data.uint64;
 
     PMIX_VALUE_RELEASE(vp);
-}
-
-inline static void
-exchange_all_rkeys(size_t r)
-{
-    int pe;
 
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        exchange_one_rkeys(r, pe);
-    }
+    return v;
 }
 
-inline static void
-exchange_one_rkeys_and_heaps(size_t r)
-{
-    int pe;
-
-    for (pe = 0; pe < proc.nranks; ++pe) {
-        exchange_one_rkeys(r, pe);
-
-#ifndef ENABLE_ALIGNED_ADDRESSES
-        exchange_one_heap(r, pe);
-#endif /* ! ENABLE_ALIGNED_ADDRESSES */
-    }  /* PE loop */
-}
+/*
+ * something that identifies this job on a node
+ */
 
-void
-shmemc_pmi_exchange_rkeys_and_heaps(void)
+const char *
+shmemc_pmi_job_name(void)
 {
-    size_t r;
-
-    /* global rkeys */
-    exchange_all_rkeys(0);
-
-    /* now everything else */
-    for (r = 1; r < proc.comms.nregions; ++r) {
-        exchange_one_rkeys_and_heaps(r);
-    }
+    return my_proc.nspace;
 }
 
 /* -------------------------------------------------------------- */
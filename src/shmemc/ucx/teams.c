@@ -18,13 +18,27 @@ shmemc_ucx_teardown_context(shmemc_context_h ch)
     size_t r;
     int pe;
 
+    logger(LOG_FINALIZE,
+           "context #%lu connected to %d of %d PEs",
+           ch->id, shmemc_ucx_connected_pes(ch), proc.nranks);
+
+    /* replies still going out on its endpoints */
+    shmemc_ucx_amo_handlers_finalize(ch);
+
     if (! proc.env.teardown_kludge) {
         shmemc_ucx_disconnect_all_eps(ch);
     }
     /* release remote access memory */
     for (r = 0; r < proc.comms.nregions; ++r) {
+        /* heap grew, but context never used the new region */
+        if (ch->racc[r].rinfo == NULL) {
+            continue;
+        }
         for (pe = 0; pe < proc.nranks; ++pe) {
-            ucp_rkey_destroy(ch->racc[r].rinfo[pe].rkey);
+            /* never connected? */
+            if (ch->racc[r].rinfo[pe].rkey != NULL) {
+                ucp_rkey_destroy(ch->racc[r].rinfo[pe].rkey);
+            }
         }
         free(ch->racc[r].rinfo);
     }